@@ -1,140 +1,552 @@
 #include <iostream>
+#include <algorithm>
 #include <vector>
 #include <list>
 #include <queue>
-#include <set>
+#include <functional>
 #include <cassert>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <charconv>
+
+// Arithmetic on capacities. Integral capacities are exact; floating-point ones count anything
+// within EPSILON of zero as zero, so that rounding does not leave edges almost saturated.
+template<class Capacity, bool = std::is_floating_point<Capacity>::value>
+struct CapacityTraits {
+    // more than any flow, with room to add another flow to it
+    constexpr static Capacity INF = std::numeric_limits<Capacity>::max() / 2;
+    constexpr static Capacity EPSILON = 0;
+
+    static bool positive(Capacity value) { return value > 0; }
+    static long long round(Capacity value) { return value; }
+};
+
+template<class Capacity>
+struct CapacityTraits<Capacity, true> {
+    constexpr static Capacity INF = std::numeric_limits<Capacity>::max() / 2;
+    constexpr static Capacity EPSILON = static_cast<Capacity>(1e-9);
+
+    static bool positive(Capacity value) { return value > EPSILON; }
+    static long long round(Capacity value) { return std::llround(value); }
+};
 
-class ResidualNetwork {
+// Cost is the type of the cost of a unit of flow, void for a network without costs
+template<class Capacity, class Cost = void>
+class ResidualNetwork;
+
+// Edges are collected by add_edge and laid out in compressed sparse rows on first use: the
+// residual edges leaving a vertex are contiguous, and their fields live in separate arrays.
+template<class Capacity>
+class ResidualNetwork<Capacity, void> {
   public:
 
-    constexpr static int INF = static_cast<int>(1e6);
-    constexpr static size_t NONE = static_cast<size_t>(1e6);
+    constexpr static size_t NONE = std::numeric_limits<size_t>::max();
 
+    // a handle to a residual edge; cheap to copy, valid until edges are added again
     class Edge {
       private:
 
-        size_t from_,
-               to_;
-        int    capacity_,
-               flow_;
+        ResidualNetwork* network_;
+        size_t           id_;
 
       public:
 
-        Edge(size_t _from, size_t _to, int _capacity)
-                : from_(_from)
-                , to_(_to)
-                , capacity_(_capacity)
-                , flow_(0)
+        Edge(ResidualNetwork* _network, size_t _id)
+                : network_(_network)
+                , id_(_id)
         {}
 
-        size_t from() const { return from_; }
-        size_t to() const { return to_; }
-        int capacity() const { return capacity_; }
-        int residual_capacity() const { return capacity_ - flow_; }
-        int& flow() { return flow_; }
-        bool saturated() { return residual_capacity() == 0; }
+        size_t position() const { return id_; }
+        Edge reverse() const { return Edge(network_, network_->reverse_[id_]); }
+        size_t from() const { return network_->to_[network_->reverse_[id_]]; }
+        size_t to() const { return network_->to_[id_]; }
+        Capacity capacity() const { return network_->capacity_[id_]; }
+        Capacity residual_capacity() const { return network_->capacity_[id_] - network_->flow_[id_]; }
+        Capacity& flow() { return network_->flow_[id_]; }
+        bool saturated() const { return !CapacityTraits<Capacity>::positive(residual_capacity()); }
     };
 
     template<bool BackEdge = false>
     class EdgeIterator {
       private:
 
-        std::vector<Edge>*   edges_;
-        std::vector<size_t>* next_edge_;
-        size_t               current_edge_id_;
+        ResidualNetwork* network_;
+        size_t           current_edge_id_,
+                         end_id_;
+
+        bool saturated_() const {
+            size_t id = (BackEdge ? network_->reverse_[current_edge_id_] : current_edge_id_);
+            return !CapacityTraits<Capacity>::positive(network_->capacity_[id] - network_->flow_[id]);
+        }
 
       public:
 
         EdgeIterator() = default;
 
-        EdgeIterator(std::vector<Edge>* _edges,
-                     std::vector<size_t>* _next_edge,
-                     size_t _start_id)
-                : edges_(_edges)
-                , next_edge_(_next_edge)
-                , current_edge_id_(_start_id) {
-            if (valid() && operator*().saturated()) {
-                operator++();
+        EdgeIterator(ResidualNetwork* _network, size_t _start_id, size_t _end_id)
+                : network_(_network)
+                , current_edge_id_(_start_id)
+                , end_id_(_end_id) {
+            while (valid() && saturated_()) {
+                ++current_edge_id_;
             }
         }
 
-        Edge& operator *() {
-            return edges_->at(current_edge_id_ ^ BackEdge);
+        Edge operator *() const {
+            return Edge(network_, BackEdge ? network_->reverse_[current_edge_id_] : current_edge_id_);
         }
 
-        Edge& back_edge() {
-            return edges_->at(current_edge_id_ ^ BackEdge ^ 1);
+        Edge back_edge() const {
+            return Edge(network_, BackEdge ? current_edge_id_ : network_->reverse_[current_edge_id_]);
         }
 
-        bool valid() {
-            return (current_edge_id_ != NONE);
+        bool valid() const {
+            return (current_edge_id_ != end_id_);
         }
 
         void operator ++() {
-            if (valid()) current_edge_id_ = next_edge_->at(current_edge_id_);
-            while (valid() && operator*().saturated()) {
-                current_edge_id_ = next_edge_->at(current_edge_id_);
+            if (valid()) ++current_edge_id_;
+            while (valid() && saturated_()) {
+                ++current_edge_id_;
             }
         }
 
-        size_t go_through() {
-            return edges_->at(current_edge_id_).to();
+        size_t go_through() const {
+            return network_->to_[current_edge_id_];
         }
     };
 
   private:
 
-    std::vector<Edge>   edges_;
-    std::vector<size_t> next_edge_,
-                        head_;
+    // residual edges in the order they were added: 2k is the k-th edge, 2k + 1 its reverse
+    std::vector<size_t>   added_from_,
+                          added_to_;
+    std::vector<Capacity> added_capacity_;
+
+    // the same edges by rows: those leaving v are first_edge_[v] .. first_edge_[v + 1] - 1
+    std::vector<size_t>   first_edge_,
+                          to_,
+                          reverse_,
+                          position_;
+    std::vector<Capacity> capacity_,
+                          flow_;
+    bool                  built_ = false,
+    // false for a grid laid out directly, which has no added_ arrays and whose edge ids are positions
+                          staged_ = true;
+
+    size_t                vertices_cnt_,
+                          source_,
+                          sink_;
+
+    void build_() {
+        size_t edges_cnt = added_to_.size();
+        first_edge_.assign(vertices_cnt_ + 1, 0);
+        for (size_t from : added_from_) {
+            ++first_edge_[from + 1];
+        }
+        for (size_t vertex_id = 0; vertex_id < vertices_cnt_; ++vertex_id) {
+            first_edge_[vertex_id + 1] += first_edge_[vertex_id];
+        }
+        std::vector<size_t> next_position(first_edge_.begin(), first_edge_.end() - 1);
+        position_.resize(edges_cnt);
+        for (size_t edge_id = 0; edge_id < edges_cnt; ++edge_id) {
+            position_[edge_id] = next_position[added_from_[edge_id]]++;
+        }
+        to_.resize(edges_cnt);
+        reverse_.resize(edges_cnt);
+        capacity_.resize(edges_cnt);
+        flow_.assign(edges_cnt, 0);
+        for (size_t edge_id = 0; edge_id < edges_cnt; ++edge_id) {
+            size_t position = position_[edge_id];
+            to_[position] = added_to_[edge_id];
+            reverse_[position] = position_[edge_id ^ 1];
+            capacity_[position] = added_capacity_[edge_id];
+        }
+        built_ = true;
+    }
 
-    size_t              vertices_cnt_,
-                        source_,
-                        sink_;
+    void ensure_built_() {
+        if (!built_) build_();
+    }
 
   public:
 
     void discard_flow() {
-        for (auto& edge : edges_) {
-            edge.flow() = 0;
-        }
+        ensure_built_();
+        std::fill(flow_.begin(), flow_.end(), 0);
     }
 
     template<bool BackEdge = false>
     EdgeIterator<BackEdge> make_iterator(size_t vertex_id) {
-        return EdgeIterator<BackEdge>(&edges_, &next_edge_, head_[vertex_id]);
+        ensure_built_();
+        return EdgeIterator<BackEdge>(this, first_edge_[vertex_id], first_edge_[vertex_id + 1]);
+    }
+
+    // the residual edge with the id add_edge returned (or that id + 1 for its reverse)
+    Edge edge(size_t edge_id) {
+        ensure_built_();
+        return Edge(this, staged_ ? position_[edge_id] : edge_id);
+    }
+
+    // Raw access to the layout for solvers that keep their own state per edge: the residual
+    // edges leaving vertex_id are edge_at(first_edge(vertex_id)) .. edge_at(first_edge(vertex_id + 1) - 1),
+    // saturated or not.
+    size_t first_edge(size_t vertex_id) {
+        ensure_built_();
+        return first_edge_[vertex_id];
+    }
+
+    Edge edge_at(size_t position) {
+        return Edge(this, position);
     }
 
     ResidualNetwork() = default;
     ResidualNetwork(size_t _n, size_t _source, size_t _sink)
             : vertices_cnt_(_n)
             , source_(_source)
-            , sink_(_sink) {
-        head_.assign(vertices_cnt_, NONE);
-    }
+            , sink_(_sink)
+    {}
 
     size_t vertices_cnt() const { return vertices_cnt_; }
     size_t source() const { return source_; }
     size_t sink() const { return sink_; }
+    size_t edges_cnt() const { return staged_ ? added_to_.size() : to_.size(); }
+
+    // makes room for edges_cnt more calls of add_edge
+    void reserve(size_t edges_cnt) {
+        added_from_.reserve(added_from_.size() + 2 * edges_cnt);
+        added_to_.reserve(added_to_.size() + 2 * edges_cnt);
+        added_capacity_.reserve(added_capacity_.size() + 2 * edges_cnt);
+    }
 
-    void add_residual_edge(size_t from, size_t to, int capacity) {
-        edges_.emplace_back(from, to, capacity);
-        next_edge_.emplace_back(head_[from]);
-        head_[from] = edges_.size() - 1;
+    // adding edges after the network was traversed lays it out again and discards the flow
+    size_t add_residual_edge(size_t from, size_t to, Capacity capacity) {
+        assert(staged_);
+        added_from_.push_back(from);
+        added_to_.push_back(to);
+        added_capacity_.push_back(capacity);
+        built_ = false;
+        return added_to_.size() - 1;
     }
 
-    void add_edge(size_t from, size_t to, int capacity, bool directed = true) {
-        add_residual_edge(from, to, capacity);
+    size_t add_edge(size_t from, size_t to, Capacity capacity, bool directed = true) {
+        size_t edge_id = add_residual_edge(from, to, capacity);
         add_residual_edge(to, from, directed ? 0 : capacity);
+        return edge_id;
+    }
+
+    // bytes held by the edge arrays, pending and laid out
+    size_t memory() const {
+        return (added_from_.capacity() + added_to_.capacity() + first_edge_.capacity() + to_.capacity() +
+                reverse_.capacity() + position_.capacity()) * sizeof(size_t) +
+               (added_capacity_.capacity() + capacity_.capacity() + flow_.capacity()) * sizeof(Capacity);
+    }
+
+    // Changes the capacity of the residual edge with the id add_edge returned (or that id + 1 for
+    // its reverse) and keeps the flow: only what no longer fits is taken off the edge, which
+    // leaves excess at its tail and a deficit at its head until a solver's resolve() repairs them.
+    void update_capacity(size_t edge_id, Capacity capacity) {
+        if (staged_) added_capacity_[edge_id] = capacity;
+        if (!built_) return;
+        Edge updated = edge(edge_id);
+        capacity_[updated.position()] = capacity;
+        if (updated.flow() > capacity) {
+            updated.reverse().flow() = -capacity;
+            updated.flow() = capacity;
+        }
+    }
+
+    // Lays out a grid of rows x columns pixels, pixel (row, column) being vertex row * columns + column
+    // and the source and the sink the two vertices after them, straight into rows: the edges follow
+    // from the grid, so nothing is staged and the memory add_edge needs for it is saved. A pixel has
+    // an edge to each of its 4 (8 if eight_connected) neighbours with capacity neighbour(from, to),
+    // and one edge with a terminal: from the source with capacity terminal(pixel) if that is not
+    // negative, to the sink with capacity -terminal(pixel) otherwise. Edge ids are positions, and no
+    // edges can be added afterwards.
+    template<class Neighbour, class Terminal>
+    static ResidualNetwork grid(size_t rows, size_t columns, bool eight_connected, Neighbour neighbour,
+                                Terminal terminal) {
+        // the 8 directions, listed so that the opposite of direction i is direction 7 - i; the 4 straight
+        // ones among them are listed the same way
+        constexpr static int ROW_STEP[]    = {-1, -1, -1,  0, 0,  1, 1, 1},
+                             COLUMN_STEP[] = {-1,  0,  1, -1, 1, -1, 0, 1},
+                             STRAIGHT[]    = {1, 3, 4, 6},
+                             ALL[]         = {0, 1, 2, 3, 4, 5, 6, 7};
+        const int* directions = (eight_connected ? ALL : STRAIGHT);
+        int directions_cnt = (eight_connected ? 8 : 4);
+        auto inside = [&](size_t row, size_t column, int direction) {
+            size_t next_row = row + ROW_STEP[directions[direction]],
+                   next_column = column + COLUMN_STEP[directions[direction]];
+            // stepping off the top or the left edge wraps around to a huge index
+            return next_row < rows && next_column < columns;
+        };
+
+        size_t pixels_cnt = rows * columns,
+               source = pixels_cnt,
+               sink = pixels_cnt + 1,
+               sources_cnt = 0;
+        ResidualNetwork network(pixels_cnt + 2, source, sink);
+        network.staged_ = false;
+        std::vector<Capacity> terminal_capacity(pixels_cnt);
+        network.first_edge_.assign(pixels_cnt + 3, 0);
+        for (size_t pixel = 0; pixel < pixels_cnt; ++pixel) {
+            size_t degree = 1;
+            for (int direction = 0; direction < directions_cnt; ++direction) {
+                degree += inside(pixel / columns, pixel % columns, direction);
+            }
+            network.first_edge_[pixel + 1] = network.first_edge_[pixel] + degree;
+            terminal_capacity[pixel] = terminal(pixel);
+            sources_cnt += (terminal_capacity[pixel] >= 0);
+        }
+        network.first_edge_[sink] = network.first_edge_[source] + sources_cnt;
+        network.first_edge_[sink + 1] = network.first_edge_[sink] + pixels_cnt - sources_cnt;
+
+        size_t edges_cnt = network.first_edge_[sink + 1];
+        network.to_.resize(edges_cnt);
+        network.reverse_.resize(edges_cnt);
+        network.capacity_.resize(edges_cnt);
+        network.flow_.assign(edges_cnt, 0);
+        // where the edge from a pixel in the given direction lies
+        auto slot = [&](size_t pixel, int direction) {
+            size_t position = network.first_edge_[pixel];
+            for (int previous = 0; previous < direction; ++previous) {
+                position += inside(pixel / columns, pixel % columns, previous);
+            }
+            return position;
+        };
+        auto link = [&](size_t position, size_t to, size_t reverse, Capacity capacity) {
+            network.to_[position] = to;
+            network.reverse_[position] = reverse;
+            network.capacity_[position] = capacity;
+        };
+        size_t next_source_edge = network.first_edge_[source],
+               next_sink_edge = network.first_edge_[sink];
+        for (size_t pixel = 0; pixel < pixels_cnt; ++pixel) {
+            size_t row = pixel / columns,
+                   column = pixel % columns,
+                   position = network.first_edge_[pixel];
+            for (int direction = 0; direction < directions_cnt; ++direction) {
+                if (!inside(row, column, direction)) continue;
+                size_t to = (row + ROW_STEP[directions[direction]]) * columns + column +
+                            COLUMN_STEP[directions[direction]];
+                link(position++, to, slot(to, directions_cnt - 1 - direction), neighbour(pixel, to));
+            }
+            if (terminal_capacity[pixel] >= 0) {
+                link(position, source, next_source_edge, 0);
+                link(next_source_edge++, pixel, position, terminal_capacity[pixel]);
+            } else {
+                link(position, sink, next_sink_edge, -terminal_capacity[pixel]);
+                link(next_sink_edge++, pixel, position, 0);
+            }
+        }
+        network.built_ = true;
+        return network;
+    }
+};
+
+// A network whose edges cost something per unit of flow, the reverse of an edge costing the
+// negative. It is a ResidualNetwork<Capacity> with the costs kept alongside, so every max-flow
+// solver runs on it unchanged, and a network without costs stores nothing for them.
+template<class Capacity, class Cost>
+class ResidualNetwork : public ResidualNetwork<Capacity, void> {
+  private:
+
+    using Plain = ResidualNetwork<Capacity, void>;
+
+    // by edge id as added, and by position once the edges are laid out
+    std::vector<Cost> added_cost_,
+                      cost_;
+
+    void ensure_costs_() {
+        assert(added_cost_.size() == Plain::edges_cnt());
+        if (cost_.size() == added_cost_.size()) return;
+        cost_.resize(added_cost_.size());
+        for (size_t edge_id = 0; edge_id < added_cost_.size(); ++edge_id) {
+            cost_[Plain::edge(edge_id).position()] = added_cost_[edge_id];
+        }
+    }
+
+  public:
+
+    class Edge : public Plain::Edge {
+      private:
+
+        const ResidualNetwork* network_;
+
+      public:
+
+        Edge(typename Plain::Edge _edge, const ResidualNetwork* _network)
+                : Plain::Edge(_edge)
+                , network_(_network)
+        {}
+
+        Edge reverse() const { return Edge(Plain::Edge::reverse(), network_); }
+        Cost cost() const { return network_->cost_[this->position()]; }
+    };
+
+    using Plain::Plain;
+
+    void reserve(size_t edges_cnt) {
+        Plain::reserve(edges_cnt);
+        added_cost_.reserve(added_cost_.size() + 2 * edges_cnt);
+    }
+
+    size_t add_edge(size_t from, size_t to, Capacity capacity, Cost cost) {
+        added_cost_.push_back(cost);
+        added_cost_.push_back(-cost);
+        return Plain::add_edge(from, to, capacity);
+    }
+
+    // also lays out the costs, which edge_at expects
+    void discard_flow() {
+        Plain::discard_flow();
+        ensure_costs_();
+    }
+
+    Edge edge(size_t edge_id) {
+        typename Plain::Edge plain = Plain::edge(edge_id);
+        ensure_costs_();
+        return Edge(plain, this);
+    }
+
+    Edge edge_at(size_t position) {
+        return Edge(Plain::edge_at(position), this);
+    }
+
+    size_t memory() const {
+        return Plain::memory() + (added_cost_.capacity() + cost_.capacity()) * sizeof(Cost);
     }
 };
 
+template<class Capacity>
 class MaxFlowAlgorithm {
+  public:
+
+    // Operation counters since init(). A push moves flow over one edge, or along a whole path for
+    // Dinic, Boykov-Kolmogorov and the repairs in resolve(); phases are layered networks for
+    // Malhotra and Dinic and global relabels for push-relabel; Boykov-Kolmogorov counts the orphans
+    // it adopts or frees as relabels.
+    struct Statistics {
+        size_t pushes, relabels, phases;
+    };
+
   protected:
 
-    ResidualNetwork* network_;
-    int              flow_;
+    using Network = ResidualNetwork<Capacity>;
+    using Traits = CapacityTraits<Capacity>;
+
+    ResidualNetwork<Capacity>* network_;
+    Capacity                   flow_;
+    std::vector<size_t>        path_edge_,
+                               search_queue_;
+    Statistics                 statistics_ = {0, 0, 0};
+
+    template<class T>
+    static size_t bytes_(const std::vector<T>& values) { return values.capacity() * sizeof(T); }
+    static size_t bytes_(const std::vector<bool>& values) { return values.capacity() / 8; }
+
+    // what flows into each vertex minus what flows out of it
+    void count_excess_(std::vector<Capacity>& excess) {
+        excess.assign(network_->vertices_cnt(), 0);
+        for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
+            for (size_t edge = network_->first_edge(vertex_id); edge < network_->first_edge(vertex_id + 1); ++edge) {
+                excess[vertex_id] -= network_->edge_at(edge).flow();
+            }
+        }
+    }
+
+    // A BFS over the residual edges leaving start (entering it if Backward) for the nearest
+    // terminal, or, going backward, the nearest vertex with excess; path_edge_ leads from the
+    // vertex found to start. NONE if there is no such vertex.
+    template<bool Backward>
+    size_t find_path_(size_t start, const std::vector<Capacity>& excess) {
+        // only what the previous search reached needs to be cleared
+        if (path_edge_.size() != network_->vertices_cnt()) {
+            path_edge_.assign(network_->vertices_cnt(), Network::NONE);
+        }
+        for (size_t vertex_id : search_queue_) {
+            path_edge_[vertex_id] = Network::NONE;
+        }
+        search_queue_.assign(1, start);
+        for (size_t head = 0; head < search_queue_.size(); ++head) {
+            size_t vertex_id = search_queue_[head];
+            for (auto it = network_->template make_iterator<Backward>(vertex_id); it.valid(); ++it) {
+                size_t next = it.go_through();
+                if (next == start || path_edge_[next] != Network::NONE) continue;
+                path_edge_[next] = (*it).position();
+                search_queue_.push_back(next);
+                if (next == network_->source() || next == network_->sink() ||
+                    (Backward && Traits::positive(excess[next]))) {
+                    return next;
+                }
+            }
+        }
+        return Network::NONE;
+    }
+
+    // moves up to amount of excess along the path find_path_ left between start and found
+    template<bool Backward>
+    void push_along_path_(size_t start, size_t found, Capacity amount, std::vector<Capacity>& excess) {
+        for (size_t vertex_id = found; vertex_id != start;) {
+            auto edge = network_->edge_at(path_edge_[vertex_id]);
+            amount = std::min(amount, edge.residual_capacity());
+            vertex_id = (Backward ? edge.to() : edge.from());
+        }
+        for (size_t vertex_id = found; vertex_id != start;) {
+            auto edge = network_->edge_at(path_edge_[vertex_id]);
+            edge.flow() += amount;
+            edge.reverse().flow() -= amount;
+            vertex_id = (Backward ? edge.to() : edge.from());
+        }
+        ++statistics_.pushes;
+        excess[Backward ? found : start] -= amount;
+        excess[Backward ? start : found] += amount;
+    }
+
+    // After capacities were lowered some vertices send out more than they get; each takes the
+    // difference back from the nearest terminal or vertex with excess, so a preflow is left.
+    void cancel_deficits_(std::vector<Capacity>& excess) {
+        for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
+            if (vertex_id == network_->source() || vertex_id == network_->sink()) continue;
+            while (Traits::positive(-excess[vertex_id])) {
+                size_t found = find_path_<true>(vertex_id, excess);
+                if (found == Network::NONE) break;
+                Capacity available = (found == network_->source() || found == network_->sink()
+                                      ? -excess[vertex_id] : std::min(-excess[vertex_id], excess[found]));
+                push_along_path_<true>(vertex_id, found, available, excess);
+            }
+        }
+    }
+
+    // sends the excess of every vertex on to the nearest terminal, turning a preflow into a flow
+    void cancel_surpluses_(std::vector<Capacity>& excess) {
+        for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
+            if (vertex_id == network_->source() || vertex_id == network_->sink()) continue;
+            while (Traits::positive(excess[vertex_id])) {
+                size_t found = find_path_<false>(vertex_id, excess);
+                if (found == Network::NONE) break;
+                push_along_path_<false>(vertex_id, found, excess[vertex_id], excess);
+            }
+        }
+    }
+
+    // repairs whatever the network holds into a flow for the current capacities
+    void restore_flow_() {
+        std::vector<Capacity> excess;
+        count_excess_(excess);
+        cancel_deficits_(excess);
+        cancel_surpluses_(excess);
+        flow_ = excess[network_->sink()];
+    }
 
   public:
 
@@ -142,19 +554,55 @@ class MaxFlowAlgorithm {
 
     void discard() { network_ = nullptr; }
 
-    void init(ResidualNetwork* _network) {
+    void init(ResidualNetwork<Capacity>* _network) {
         network_ = _network;
         flow_ = 0;
+        statistics_ = {0, 0, 0};
     }
 
-    int flow() const { return flow_; }
+    Capacity flow() const { return flow_; }
+
+    const Statistics& statistics() const { return statistics_; }
+
+    // bytes held by the solver's own arrays, not counting the network
+    virtual size_t memory() const { return bytes_(path_edge_) + bytes_(search_queue_); }
+
+    // The source side of a minimum cut: the vertices that cannot reach the sink over residual
+    // edges. Holds after run() or resolve() whether the network is left with a flow or with a
+    // maximum preflow.
+    std::vector<bool> min_cut() {
+        std::vector<bool> source_side(network_->vertices_cnt(), true);
+        std::vector<size_t> bfs_queue(1, network_->sink());
+        bfs_queue.reserve(network_->vertices_cnt());
+        source_side[network_->sink()] = false;
+        for (size_t head = 0; head < bfs_queue.size(); ++head) {
+            for (auto it = network_->template make_iterator<true>(bfs_queue[head]); it.valid(); ++it) {
+                if (source_side[it.go_through()]) {
+                    source_side[it.go_through()] = false;
+                    bfs_queue.push_back(it.go_through());
+                }
+            }
+        }
+        return source_side;
+    }
 
     virtual void run() = 0;
+
+    // Solves again after ResidualNetwork::update_capacity, starting from the flow the network
+    // still holds; solvers that cannot warm-start just run from scratch.
+    virtual void resolve() { run(); }
 };
 
-class Malhotra : public MaxFlowAlgorithm {
+template<class Capacity>
+class Malhotra : public MaxFlowAlgorithm<Capacity> {
   private:
 
+    using Network = ResidualNetwork<Capacity>;
+    using Traits = CapacityTraits<Capacity>;
+    using MaxFlowAlgorithm<Capacity>::network_;
+    using MaxFlowAlgorithm<Capacity>::flow_;
+    using MaxFlowAlgorithm<Capacity>::statistics_;
+
     enum DIRECTION {
         LEFT = -1,
         RIGHT = 1
@@ -164,36 +612,40 @@ class Malhotra : public MaxFlowAlgorithm {
     class LayeredEdgeIterator {
       private:
 
-        ResidualNetwork::EdgeIterator<direction == LEFT> current_edge_;
+        typename Network::template EdgeIterator<direction == LEFT> current_edge_;
         std::vector<int>* layer_id_;
+        size_t vertex_id_;
 
         int delta_(size_t vertex1_id, size_t vertex2_id) const {
-            return layer_id_->at(vertex2_id) - layer_id_->at(vertex1_id);
+            return (*layer_id_)[vertex2_id] - (*layer_id_)[vertex1_id];
         }
 
         bool correct_delta_() {
-            return delta_((*current_edge_).from(), (*current_edge_).to()) == 1;
+            return (direction == LEFT
+                    ? delta_(current_edge_.go_through(), vertex_id_)
+                    : delta_(vertex_id_, current_edge_.go_through())) == 1;
         }
 
       public:
 
         LayeredEdgeIterator() = default;
 
-        LayeredEdgeIterator(ResidualNetwork* _network,
+        LayeredEdgeIterator(Network* _network,
                             size_t _vertex_id,
                             std::vector<int>* _layer_id)
-            : current_edge_(_network->make_iterator<direction == LEFT>(_vertex_id))
-            , layer_id_(_layer_id) {
+            : current_edge_(_network->template make_iterator<direction == LEFT>(_vertex_id))
+            , layer_id_(_layer_id)
+            , vertex_id_(_vertex_id) {
             if (valid() && !correct_delta_()) {
                 operator ++();
             }
         }
 
-        ResidualNetwork::Edge& operator *() {
+        typename Network::Edge operator *() const {
             return *current_edge_;
         }
 
-        ResidualNetwork::Edge& back_edge() {
+        typename Network::Edge back_edge() const {
             return current_edge_.back_edge();
         }
 
@@ -213,31 +665,55 @@ class Malhotra : public MaxFlowAlgorithm {
         }
     };
 
-    std::vector<int>                 potential_in_,
+    std::vector<Capacity>            potential_in_,
                                      potential_out_,
-                                     excess_,
-                                     layer_id_;
-    std::vector<char>                deleted_,
-                                     can_reach_sink_;
+                                     excess_;
+    std::vector<int>                 layer_id_;
+    // read on every push, so kept a byte per vertex; the other flags take a bit
+    std::vector<char>                deleted_;
+    std::vector<bool>                can_reach_sink_,
+                                     visited_;
+    // vertices in the order push_ passes the flow through them
+    std::vector<size_t>              pass_order_;
+    // vertices whose potential went down since the last delete_saturated_vertices_
+    std::vector<size_t>              touched_,
+                                     saturated_;
+    // a min-heap of (potential, vertex); an entry is stale once the vertex is deleted or its
+    // potential has changed, and potentials only go down within a phase
+    std::vector<std::pair<Capacity, size_t>> reference_heap_;
 
     std::vector<LayeredEdgeIterator<LEFT>>  iterator_left_;
     std::vector<LayeredEdgeIterator<RIGHT>> iterator_right_;
+    std::vector<size_t>                     frontier_,
+                                            next_frontier_;
+
+    constexpr static int NO_LAYER = std::numeric_limits<int>::max();
 
-    int potential_(size_t u) {
+    Capacity potential_(size_t u) {
         return std::min(potential_in_[u], potential_out_[u]);
     }
 
-    void mark_reachable_(size_t vertex_id, std::vector<char>& visited) {
+    // walks the layers back from vertex_id one frontier at a time, so the depth of the
+    // network does not matter
+    void mark_reachable_(size_t vertex_id, std::vector<bool>& visited) {
         visited[vertex_id] = true;
-        for (LayeredEdgeIterator<LEFT> it(network_, vertex_id, &layer_id_); it.valid(); ++it) {
-            if (!visited[it.go_through()]) {
-                mark_reachable_(it.go_through(), visited);
+        frontier_.assign(1, vertex_id);
+        while (!frontier_.empty()) {
+            next_frontier_.clear();
+            for (size_t from : frontier_) {
+                for (LayeredEdgeIterator<LEFT> it(network_, from, &layer_id_); it.valid(); ++it) {
+                    if (!visited[it.go_through()]) {
+                        visited[it.go_through()] = true;
+                        next_frontier_.push_back(it.go_through());
+                    }
+                }
             }
+            frontier_.swap(next_frontier_);
         }
     }
 
     bool build_layers_() {
-        layer_id_.assign(network_->vertices_cnt(), ResidualNetwork::INF);
+        layer_id_.assign(network_->vertices_cnt(), NO_LAYER);
         layer_id_[network_->source()] = 0;
         std::queue<size_t> bfs_queue;
         bfs_queue.push(network_->source());
@@ -255,21 +731,21 @@ class Malhotra : public MaxFlowAlgorithm {
         mark_reachable_(network_->sink(), can_reach_sink_);
         for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
             if (!can_reach_sink_[vertex_id]) {
-                layer_id_[vertex_id] = ResidualNetwork::INF;
+                layer_id_[vertex_id] = NO_LAYER;
             }
         }
-        return (layer_id_[network_->sink()] < ResidualNetwork::INF);
+        return (layer_id_[network_->sink()] < NO_LAYER);
     }
 
     template<DIRECTION direction>
-    void count_potentials_(std::vector<int>& potential, size_t special_vertex) {
+    void count_potentials_(std::vector<Capacity>& potential, size_t special_vertex) {
         potential.assign(network_->vertices_cnt(), 0);
-        potential[special_vertex] = ResidualNetwork::INF;
         for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
             for (LayeredEdgeIterator<direction> it(network_, vertex_id, &layer_id_); it.valid(); ++it) {
                 potential[vertex_id] += (*it).residual_capacity();
             }
         }
+        potential[special_vertex] = Traits::INF;
     }
 
     template<DIRECTION direction>
@@ -285,97 +761,139 @@ class Malhotra : public MaxFlowAlgorithm {
         count_potentials_<RIGHT>(potential_out_, network_->sink());
         init_edge_iterators_<LEFT>(iterator_left_);
         init_edge_iterators_<RIGHT>(iterator_right_);
+        reset_scratch_();
+    }
+
+    // within a phase push_ clears what it dirtied, so these are reset only here
+    void reset_scratch_() {
         deleted_.assign(network_->vertices_cnt(), false);
+        visited_.assign(network_->vertices_cnt(), false);
+        excess_.assign(network_->vertices_cnt(), 0);
+        reference_heap_.clear();
+        // every potential has just been counted anew
+        touched_.resize(network_->vertices_cnt());
+        for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
+            touched_[vertex_id] = vertex_id;
+        }
     }
 
-    std::vector<int>& direction_to_potential_(DIRECTION direction) {
+    std::vector<Capacity>& direction_to_potential_(DIRECTION direction) {
         return (direction == LEFT ? potential_out_ : potential_in_);
     }
 
+    // a vertex left with no potential is deleted, otherwise its new potential goes to the heap
+    void update_(size_t vertex_id) {
+        if (deleted_[vertex_id]) return;
+        if (!Traits::positive(potential_(vertex_id))) {
+            // marked as soon as it is queued, so that no vertex is deleted twice
+            deleted_[vertex_id] = true;
+            saturated_.push_back(vertex_id);
+        } else {
+            // put in order by delete_saturated_vertices_
+            reference_heap_.emplace_back(potential_(vertex_id), vertex_id);
+        }
+    }
+
+    bool stale_(const std::pair<Capacity, size_t>& entry) {
+        return deleted_[entry.second] || entry.first != potential_(entry.second);
+    }
+
     template<DIRECTION direction>
-    void delete_adjacent_(size_t vertex_id, std::queue<size_t>& saturated) {
+    void delete_adjacent_(size_t vertex_id) {
         for (LayeredEdgeIterator<direction> it(network_, vertex_id, &layer_id_); it.valid(); ++it) {
             size_t to = it.go_through();
+            if (deleted_[to]) continue;
             direction_to_potential_(direction)[to] -= (*it).residual_capacity();
-            if (potential_(to) == 0 && !deleted_[to]) {
-                deleted_[to] = true;
-                saturated.push(to);
-            }
+            update_(to);
         }
     }
 
     void delete_saturated_vertices_() {
-        std::queue<size_t> saturated;
-        for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
-            if (!deleted_[vertex_id] && potential_(vertex_id) == 0) {
-                saturated.push(vertex_id);
-            }
+        size_t heap_size = reference_heap_.size();
+        saturated_.clear();
+        for (size_t vertex_id : touched_) {
+            update_(vertex_id);
         }
-        while (!saturated.empty()) {
-            size_t vertex_id = saturated.front();
-            saturated.pop();
-            deleted_[vertex_id] = true;
-            delete_adjacent_<LEFT>(vertex_id, saturated);
-            delete_adjacent_<RIGHT>(vertex_id, saturated);
+        touched_.clear();
+        for (size_t head = 0; head < saturated_.size(); ++head) {
+            delete_adjacent_<LEFT>(saturated_[head]);
+            delete_adjacent_<RIGHT>(saturated_[head]);
+        }
+        // a heap of mostly stale entries is rebuilt from the live ones, and so is one that more
+        // than doubled, where sifting up every new entry costs more than heapifying the whole
+        if (reference_heap_.size() > 2 * network_->vertices_cnt()) {
+            reference_heap_.erase(std::remove_if(reference_heap_.begin(), reference_heap_.end(),
+                                                 [this](const std::pair<Capacity, size_t>& entry) {
+                                                     return stale_(entry);
+                                                 }),
+                                  reference_heap_.end());
+            heap_size = 0;
+        }
+        if (reference_heap_.size() > 2 * heap_size) {
+            std::make_heap(reference_heap_.begin(), reference_heap_.end(), std::greater<>());
+        } else {
+            for (size_t entry_id = heap_size; entry_id < reference_heap_.size(); ++entry_id) {
+                std::push_heap(reference_heap_.begin(), reference_heap_.begin() + entry_id + 1, std::greater<>());
+            }
         }
     }
 
+    // the vertex of the least positive potential, the one with the least id among equal ones
     size_t get_reference_node() {
-        size_t reference_node = ResidualNetwork::NONE;
-        for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
-            if (potential_(vertex_id) > 0 && (
-                    reference_node == ResidualNetwork::NONE ||
-                    potential_(reference_node) > potential_(vertex_id))
-                    ) {
-                reference_node = vertex_id;
-            }
+        while (stale_(reference_heap_.front())) {
+            std::pop_heap(reference_heap_.begin(), reference_heap_.end(), std::greater<>());
+            reference_heap_.pop_back();
         }
-        return reference_node;
+        return reference_heap_.front().second;
     }
 
     template<DIRECTION direction>
-    void push_(size_t reference_node, int push_value,
+    void push_(size_t reference_node, Capacity push_value,
                std::vector<LayeredEdgeIterator<direction>>& iterator
     ) {
-        excess_.assign(network_->vertices_cnt(), 0);
         excess_[reference_node] = push_value;
-        std::queue<size_t> bfs_queue;
-        bfs_queue.push(reference_node);
         direction_to_potential_(direction)[reference_node] += push_value;
-        std::vector<char> visited(network_->vertices_cnt(), false);
-        while (!bfs_queue.empty()) {
-            size_t vertex_id = bfs_queue.front();
-            bfs_queue.pop();
-            visited[vertex_id] = true;
-            potential_in_[vertex_id] -= push_value;
-            potential_out_[vertex_id] -= push_value;
-            for (LayeredEdgeIterator<direction>& it = iterator[vertex_id]; it.valid(); ++it) {
+        pass_order_.assign(1, reference_node);
+        visited_[reference_node] = true;
+        for (size_t head = 0; head < pass_order_.size(); ++head) {
+            size_t vertex_id = pass_order_[head];
+            // the layers are processed in order, so everything that comes to vertex_id is already here
+            Capacity passing = excess_[vertex_id];
+            potential_in_[vertex_id] -= passing;
+            potential_out_[vertex_id] -= passing;
+            for (LayeredEdgeIterator<direction>& it = iterator[vertex_id];
+                 it.valid() && Traits::positive(excess_[vertex_id]); ++it) {
                 size_t to = it.go_through();
                 if (deleted_[to]) continue;
-                int push_through_edge = std::min(push_value, (*it).residual_capacity());
+                Capacity push_through_edge = std::min(excess_[vertex_id], (*it).residual_capacity());
                 excess_[vertex_id] -= push_through_edge;
                 excess_[to] += push_through_edge;
                 (*it).flow() += push_through_edge;
                 it.back_edge().flow() -= push_through_edge;
-                if (!visited[to]) {
-                    visited[to] = true;
-                    bfs_queue.push(to);
+                ++statistics_.pushes;
+                if (!visited_[to]) {
+                    visited_[to] = true;
+                    pass_order_.push_back(to);
                 }
                 if (!(*it).saturated()) break;
             }
         }
+        for (size_t vertex_id : pass_order_) {
+            visited_[vertex_id] = false;
+            excess_[vertex_id] = 0;
+            touched_.push_back(vertex_id);
+        }
     }
 
-  public:
-
-    void run() override {
-        network_->discard_flow();
+    // adds blocking flows to the flow in the network until it is maximum
+    void augment_() {
         while (build_layers_()) {
+            ++statistics_.phases;
             init_iteration_();
             delete_saturated_vertices_();
-            while (potential_(network_->sink()) > 0) {
+            while (Traits::positive(potential_(network_->sink()))) {
                 size_t reference_node = get_reference_node();
-                int push_value = potential_(reference_node);
+                Capacity push_value = potential_(reference_node);
                 flow_ += push_value;
                 push_<RIGHT>(reference_node, push_value, iterator_right_);
                 push_<LEFT>(reference_node, push_value, iterator_left_);
@@ -383,49 +901,79 @@ class Malhotra : public MaxFlowAlgorithm {
             }
         }
     }
+
+  public:
+
+    size_t memory() const override {
+        return MaxFlowAlgorithm<Capacity>::memory() + this->bytes_(potential_in_) + this->bytes_(potential_out_) +
+               this->bytes_(excess_) + this->bytes_(layer_id_) + this->bytes_(deleted_) + this->bytes_(can_reach_sink_) +
+               this->bytes_(visited_) + this->bytes_(pass_order_) + this->bytes_(touched_) + this->bytes_(saturated_) +
+               this->bytes_(reference_heap_) + this->bytes_(iterator_left_) + this->bytes_(iterator_right_) +
+               this->bytes_(frontier_) + this->bytes_(next_frontier_);
+    }
+
+    void run() override {
+        network_->discard_flow();
+        flow_ = 0;
+        augment_();
+    }
+
+    void resolve() override {
+        this->restore_flow_();
+        augment_();
+    }
 };
 
-class PushRelabel : public MaxFlowAlgorithm {
+template<class Capacity>
+class PushRelabel : public MaxFlowAlgorithm<Capacity> {
   private:
 
+    using Network = ResidualNetwork<Capacity>;
+    using Traits = CapacityTraits<Capacity>;
+    using MaxFlowAlgorithm<Capacity>::network_;
+    using MaxFlowAlgorithm<Capacity>::flow_;
+    using MaxFlowAlgorithm<Capacity>::statistics_;
+
     std::vector<size_t> height_;
-    std::vector<int> excess_;
+    std::vector<Capacity> excess_;
 
-    void push_through_edge_(ResidualNetwork::EdgeIterator<> it, int push_value) {
+    void push_through_edge_(typename Network::template EdgeIterator<> it, Capacity push_value) {
         (*it).flow() += push_value;
         it.back_edge().flow() -= push_value;
+        ++statistics_.pushes;
     }
 
-    void push_and_update_excess_(ResidualNetwork::EdgeIterator<> it) {
-        int push_value = std::min(excess_[it.back_edge().to()], (*it).residual_capacity());
+    void push_and_update_excess_(typename Network::template EdgeIterator<> it) {
+        Capacity push_value = std::min(excess_[it.back_edge().to()], (*it).residual_capacity());
         push_through_edge_(it, push_value);
         excess_[it.back_edge().to()] -= push_value;
         excess_[(*it).to()] += push_value;
     }
 
     void relabel_(size_t vertex_id) {
-        auto minimal_adjacent_height = static_cast<size_t>(ResidualNetwork::INF);
+        // heights never reach 2V
+        size_t minimal_adjacent_height = 2 * network_->vertices_cnt();
         for (auto it = network_->make_iterator(vertex_id); it.valid(); ++it) {
             if ((*it).saturated()) continue;
             minimal_adjacent_height = std::min(minimal_adjacent_height,
                                                height_[(*it).to()]);
         }
         height_[vertex_id] = minimal_adjacent_height + 1;
+        ++statistics_.relabels;
     }
 
+    // excess_ already holds the preflow the network starts from
     void init_() {
-        excess_.assign(network_->vertices_cnt(), 0);
-        excess_[network_->source()] = ResidualNetwork::INF;
+        excess_[network_->source()] = Traits::INF;
         height_.assign(network_->vertices_cnt(), 0);
         height_[network_->source()] = network_->vertices_cnt();
-        network_->discard_flow();
         for (auto it = network_->make_iterator(network_->source()); it.valid(); ++it) {
             push_and_update_excess_(it);
         }
     }
 
     void discharge_(size_t vertex_id) {
-        while (excess_[vertex_id] > 0) {
+        while (Traits::positive(excess_[vertex_id])) {
             for (auto it = network_->make_iterator(vertex_id); it.valid(); ++it) {
                 if ((*it).saturated()) continue;
                 if (height_[vertex_id] == height_[(*it).to()] + 1) {
@@ -436,9 +984,7 @@ class PushRelabel : public MaxFlowAlgorithm {
         }
     }
 
-  public:
-
-    void run() override {
+    void discharge_all_() {
         init_();
         std::list<size_t> order;
         for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
@@ -457,70 +1003,1860 @@ class PushRelabel : public MaxFlowAlgorithm {
         }
         flow_ = excess_[network_->sink()];
     }
+
+  public:
+
+    size_t memory() const override {
+        return MaxFlowAlgorithm<Capacity>::memory() + this->bytes_(height_) + this->bytes_(excess_);
+    }
+
+    void run() override {
+        network_->discard_flow();
+        excess_.assign(network_->vertices_cnt(), 0);
+        discharge_all_();
+    }
+
+    void resolve() override {
+        this->count_excess_(excess_);
+        this->cancel_deficits_(excess_);
+        discharge_all_();
+    }
 };
 
-struct Data {
-    size_t topic_cnt;
-    std::vector<int> values;
-    std::vector<std::set<size_t>> dependencies;
+// Push-relabel that always discharges the highest active vertex. Active vertices sit in buckets
+// by height, every vertex keeps its current arc between discharges, heights are recomputed exactly
+// by a backward BFS from the sink once enough relabelling work has piled up, and a height emptied
+// by a relabel (a gap) cuts everything above it off from the sink at once. Only the first phase is
+// run: flow() is the maximum flow value and the network is left holding a maximum preflow.
+template<class Capacity>
+class HighestLabelPushRelabel : public MaxFlowAlgorithm<Capacity> {
+  private:
 
-    void read(std::istream& in) {
-        in >> topic_cnt;
-        values.resize(topic_cnt);
-        dependencies.resize(topic_cnt);
-        for (auto& value : values) {
-            in >> value;
+    using Network = ResidualNetwork<Capacity>;
+    using Traits = CapacityTraits<Capacity>;
+    using EdgeIterator = typename Network::template EdgeIterator<>;
+    using MaxFlowAlgorithm<Capacity>::network_;
+    using MaxFlowAlgorithm<Capacity>::flow_;
+    using MaxFlowAlgorithm<Capacity>::statistics_;
+
+    // global relabels happen after GLOBAL_RELABEL_ALPHA * vertices + edges units of relabel work
+    constexpr static size_t GLOBAL_RELABEL_ALPHA = 6;
+    constexpr static size_t RELABEL_WORK = 12;
+
+    size_t                           vertices_cnt_,
+                                     highest_,
+                                     highest_active_,
+                                     work_;
+    std::vector<size_t>              height_,
+                                     first_in_layer_,
+                                     next_in_layer_,
+                                     prev_in_layer_,
+                                     bfs_queue_;
+    std::vector<Capacity>            excess_;
+    std::vector<std::vector<size_t>> active_;
+    std::vector<EdgeIterator>        current_arc_;
+
+    // every vertex below height vertices_cnt_ is in the list of its layer, active or not
+    void add_to_layer_(size_t vertex_id) {
+        size_t height = height_[vertex_id];
+        next_in_layer_[vertex_id] = first_in_layer_[height];
+        prev_in_layer_[vertex_id] = Network::NONE;
+        if (first_in_layer_[height] != Network::NONE) {
+            prev_in_layer_[first_in_layer_[height]] = vertex_id;
         }
-        for (size_t topic_id = 0; topic_id < topic_cnt; ++topic_id) {
-            size_t dependencies_cnt;
-            in >> dependencies_cnt;
-            while (dependencies_cnt--) {
-                size_t required_topic_id;
-                in >> required_topic_id;
-                dependencies[topic_id].insert(required_topic_id - 1);
+        first_in_layer_[height] = vertex_id;
+        highest_ = std::max(highest_, height);
+    }
+
+    void remove_from_layer_(size_t vertex_id) {
+        if (prev_in_layer_[vertex_id] != Network::NONE) {
+            next_in_layer_[prev_in_layer_[vertex_id]] = next_in_layer_[vertex_id];
+        } else {
+            first_in_layer_[height_[vertex_id]] = next_in_layer_[vertex_id];
+        }
+        if (next_in_layer_[vertex_id] != Network::NONE) {
+            prev_in_layer_[next_in_layer_[vertex_id]] = prev_in_layer_[vertex_id];
+        }
+    }
+
+    void activate_(size_t vertex_id) {
+        active_[height_[vertex_id]].push_back(vertex_id);
+        highest_active_ = std::max(highest_active_, height_[vertex_id]);
+    }
+
+    void global_relabel_() {
+        ++statistics_.phases;
+        work_ = 0;
+        highest_ = highest_active_ = 0;
+        height_.assign(vertices_cnt_, vertices_cnt_);
+        first_in_layer_.assign(vertices_cnt_, Network::NONE);
+        for (auto& bucket : active_) {
+            bucket.clear();
+        }
+        height_[network_->sink()] = 0;
+        bfs_queue_.assign(1, network_->sink());
+        for (size_t head = 0; head < bfs_queue_.size(); ++head) {
+            size_t vertex_id = bfs_queue_[head];
+            add_to_layer_(vertex_id);
+            current_arc_[vertex_id] = network_->make_iterator(vertex_id);
+            if (Traits::positive(excess_[vertex_id]) && vertex_id != network_->sink()) {
+                activate_(vertex_id);
+            }
+            for (auto it = network_->template make_iterator<true>(vertex_id); it.valid(); ++it) {
+                size_t from = it.go_through();
+                if (height_[from] == vertices_cnt_ && from != network_->source()) {
+                    height_[from] = height_[vertex_id] + 1;
+                    bfs_queue_.push_back(from);
+                }
             }
         }
     }
-};
 
-template<class MaxFlowAlgorithm>
-int solve(const Data& data) {
-    size_t source_id = data.topic_cnt,
-            sink_id   = data.topic_cnt + 1;
-    ResidualNetwork network(data.topic_cnt + 2, source_id, sink_id);
-    int positive_sum = 0;
-    for (size_t i = 0; i < data.topic_cnt; ++i) {
-        positive_sum += std::max(data.values[i], 0);
-        for (size_t j = 0; j < i; ++j) {
-            if (data.dependencies[i].count(j)) {
-                network.add_edge(i, j, ResidualNetwork::INF, !data.dependencies[j].count(i));
-            } else if (data.dependencies[j].count(i)) {
-                network.add_edge(j, i, ResidualNetwork::INF);
+    // nothing above an empty layer can reach the sink any more
+    void gap_(size_t empty_height) {
+        for (size_t height = empty_height + 1; height <= highest_; ++height) {
+            for (size_t vertex_id = first_in_layer_[height];
+                 vertex_id != Network::NONE; vertex_id = next_in_layer_[vertex_id]) {
+                height_[vertex_id] = vertices_cnt_;
             }
+            first_in_layer_[height] = Network::NONE;
+            active_[height].clear();
         }
+        highest_ = highest_active_ = empty_height - 1;
     }
-    for (size_t topic_id = 0; topic_id < data.topic_cnt; ++topic_id) {
-        if (data.values[topic_id] >= 0) {
-            network.add_edge(source_id, topic_id, data.values[topic_id]);
-        } else {
-            network.add_edge(topic_id, sink_id, -data.values[topic_id]);
+
+    void relabel_(size_t vertex_id) {
+        size_t old_height = height_[vertex_id];
+        remove_from_layer_(vertex_id);
+        if (first_in_layer_[old_height] == Network::NONE) {
+            gap_(old_height);
+            height_[vertex_id] = vertices_cnt_;
+            return;
+        }
+        size_t minimal_height = vertices_cnt_;
+        work_ += RELABEL_WORK;
+        for (auto it = network_->make_iterator(vertex_id); it.valid(); ++it) {
+            minimal_height = std::min(minimal_height, height_[it.go_through()] + 1);
+            ++work_;
+        }
+        height_[vertex_id] = minimal_height;
+        ++statistics_.relabels;
+        current_arc_[vertex_id] = network_->make_iterator(vertex_id);
+        if (minimal_height < vertices_cnt_) {
+            add_to_layer_(vertex_id);
         }
     }
-    MaxFlowAlgorithm algorithm;
-    algorithm.init(&network);
-    algorithm.run();
-    return positive_sum - algorithm.flow();
-}
 
-void run(std::istream& in, std::ostream& out) {
-    Data data;
-    data.read(in);
-    int answer_malhotra     = solve<Malhotra>(data);
-    int answer_pushrelabel  = solve<PushRelabel>(data);
-    assert(answer_malhotra == answer_pushrelabel);
-    out << answer_malhotra;
-}
+    void discharge_(size_t vertex_id) {
+        while (Traits::positive(excess_[vertex_id])) {
+            EdgeIterator& it = current_arc_[vertex_id];
+            if (!it.valid()) {
+                relabel_(vertex_id);
+                if (height_[vertex_id] >= vertices_cnt_) return;
+                continue;
+            }
+            size_t to = it.go_through();
+            if (height_[vertex_id] != height_[to] + 1) {
+                ++it;
+                continue;
+            }
+            Capacity push_value = std::min(excess_[vertex_id], (*it).residual_capacity());
+            (*it).flow() += push_value;
+            it.back_edge().flow() -= push_value;
+            ++statistics_.pushes;
+            if (!Traits::positive(excess_[to]) && to != network_->sink()) {
+                activate_(to);
+            }
+            excess_[vertex_id] -= push_value;
+            excess_[to] += push_value;
+            if ((*it).saturated()) ++it;
+        }
+    }
 
-int main() {
-    run(std::cin, std::cout);
-}
\ No newline at end of file
+    // excess_ already holds the preflow the network starts from
+    void discharge_all_() {
+        next_in_layer_.assign(vertices_cnt_, Network::NONE);
+        prev_in_layer_.assign(vertices_cnt_, Network::NONE);
+        current_arc_.resize(vertices_cnt_);
+        active_.assign(vertices_cnt_, {});
+        for (auto it = network_->make_iterator(network_->source()); it.valid(); ++it) {
+            Capacity push_value = (*it).residual_capacity();
+            (*it).flow() += push_value;
+            it.back_edge().flow() -= push_value;
+            excess_[(*it).to()] += push_value;
+        }
+        global_relabel_();
+        size_t work_limit = GLOBAL_RELABEL_ALPHA * vertices_cnt_ + network_->edges_cnt();
+        while (true) {
+            while (highest_active_ > 0 && active_[highest_active_].empty()) {
+                --highest_active_;
+            }
+            if (active_[highest_active_].empty()) break;
+            size_t vertex_id = active_[highest_active_].back();
+            active_[highest_active_].pop_back();
+            discharge_(vertex_id);
+            if (work_ > work_limit) {
+                global_relabel_();
+            }
+        }
+        flow_ = excess_[network_->sink()];
+    }
+
+  public:
+
+    size_t memory() const override {
+        size_t bytes = MaxFlowAlgorithm<Capacity>::memory() + this->bytes_(height_) + this->bytes_(first_in_layer_) +
+                       this->bytes_(next_in_layer_) + this->bytes_(prev_in_layer_) + this->bytes_(bfs_queue_) +
+                       this->bytes_(excess_) + this->bytes_(active_) + this->bytes_(current_arc_);
+        for (const auto& bucket : active_) {
+            bytes += this->bytes_(bucket);
+        }
+        return bytes;
+    }
+
+    void run() override {
+        vertices_cnt_ = network_->vertices_cnt();
+        network_->discard_flow();
+        excess_.assign(vertices_cnt_, 0);
+        discharge_all_();
+    }
+
+    void resolve() override {
+        vertices_cnt_ = network_->vertices_cnt();
+        this->count_excess_(excess_);
+        this->cancel_deficits_(excess_);
+        discharge_all_();
+    }
+};
+
+// Dinic: a BFS from the source splits the residual network into levels, then a blocking flow
+// over the level graph is found by augmenting paths. Each vertex keeps its current arc for the
+// whole phase and a vertex found to be a dead end is dropped from the level graph, so a phase
+// takes O(VE). The search walks the path explicitly rather than recursing.
+template<class Capacity>
+class Dinic : public MaxFlowAlgorithm<Capacity> {
+  protected:
+
+    using Network = ResidualNetwork<Capacity>;
+    using Traits = CapacityTraits<Capacity>;
+    using EdgeIterator = typename Network::template EdgeIterator<>;
+    using MaxFlowAlgorithm<Capacity>::network_;
+    using MaxFlowAlgorithm<Capacity>::flow_;
+    using MaxFlowAlgorithm<Capacity>::statistics_;
+
+    constexpr static size_t NO_LEVEL = Network::NONE;
+
+    // only edges with at least this much residual capacity are used
+    Capacity                  threshold_ = 0;
+    std::vector<size_t>       level_,
+                              bfs_queue_,
+                              path_;
+    std::vector<EdgeIterator> current_arc_;
+
+    bool enough_(Capacity residual_capacity) const {
+        return residual_capacity >= threshold_ && Traits::positive(residual_capacity);
+    }
+
+    bool admissible_(size_t vertex_id, EdgeIterator& it) {
+        return level_[it.go_through()] == level_[vertex_id] + 1 && enough_((*it).residual_capacity());
+    }
+
+    bool build_levels_() {
+        level_.assign(network_->vertices_cnt(), NO_LEVEL);
+        level_[network_->source()] = 0;
+        bfs_queue_.assign(1, network_->source());
+        for (size_t head = 0; head < bfs_queue_.size(); ++head) {
+            size_t vertex_id = bfs_queue_[head];
+            current_arc_[vertex_id] = network_->make_iterator(vertex_id);
+            for (auto it = network_->make_iterator(vertex_id); it.valid(); ++it) {
+                if (level_[it.go_through()] == NO_LEVEL && enough_((*it).residual_capacity())) {
+                    level_[it.go_through()] = level_[vertex_id] + 1;
+                    bfs_queue_.push_back(it.go_through());
+                }
+            }
+        }
+        return level_[network_->sink()] != NO_LEVEL;
+    }
+
+    void blocking_flow_() {
+        ++statistics_.phases;
+        size_t vertex_id = network_->source();
+        path_.clear();
+        while (true) {
+            if (vertex_id == network_->sink()) {
+                Capacity push_value = std::numeric_limits<Capacity>::max();
+                for (size_t from : path_) {
+                    push_value = std::min(push_value, (*current_arc_[from]).residual_capacity());
+                }
+                size_t retreat = path_.size();
+                for (size_t index = path_.size(); index-- > 0;) {
+                    EdgeIterator& it = current_arc_[path_[index]];
+                    (*it).flow() += push_value;
+                    it.back_edge().flow() -= push_value;
+                    if (!enough_((*it).residual_capacity())) retreat = index;
+                }
+                flow_ += push_value;
+                ++statistics_.pushes;
+                vertex_id = path_[retreat];
+                path_.resize(retreat);
+                continue;
+            }
+            EdgeIterator& it = current_arc_[vertex_id];
+            while (it.valid() && !admissible_(vertex_id, it)) {
+                ++it;
+            }
+            if (it.valid()) {
+                path_.push_back(vertex_id);
+                vertex_id = it.go_through();
+                continue;
+            }
+            if (path_.empty()) return;
+            level_[vertex_id] = NO_LEVEL;
+            vertex_id = path_.back();
+            path_.pop_back();
+        }
+    }
+
+    // adds blocking flows to the flow in the network until it is maximum
+    virtual void augment_() {
+        threshold_ = 0;
+        while (build_levels_()) {
+            blocking_flow_();
+        }
+    }
+
+  public:
+
+    size_t memory() const override {
+        return MaxFlowAlgorithm<Capacity>::memory() + this->bytes_(level_) + this->bytes_(bfs_queue_) +
+               this->bytes_(path_) + this->bytes_(current_arc_);
+    }
+
+    void run() override {
+        network_->discard_flow();
+        flow_ = 0;
+        current_arc_.resize(network_->vertices_cnt());
+        augment_();
+    }
+
+    void resolve() override {
+        this->restore_flow_();
+        current_arc_.resize(network_->vertices_cnt());
+        augment_();
+    }
+};
+
+// Dinic with capacity scaling: phases first use only edges with a large residual capacity, and
+// the threshold is halved whenever no path of such edges is left.
+template<class Capacity>
+class ScalingDinic : public Dinic<Capacity> {
+  private:
+
+    using Traits = CapacityTraits<Capacity>;
+    using Dinic<Capacity>::network_;
+    using Dinic<Capacity>::threshold_;
+    using Dinic<Capacity>::build_levels_;
+    using Dinic<Capacity>::blocking_flow_;
+
+  protected:
+
+    void augment_() override {
+        Capacity max_capacity = 0;
+        for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
+            for (auto it = network_->make_iterator(vertex_id); it.valid(); ++it) {
+                max_capacity = std::max(max_capacity, (*it).capacity());
+            }
+        }
+        // the last phase, with no threshold at all, only finds anything for fractional capacities
+        for (threshold_ = 1; threshold_ <= max_capacity / 2; threshold_ *= 2) {}
+        for (; threshold_ > Traits::EPSILON; threshold_ /= 2) {
+            while (build_levels_()) {
+                blocking_flow_();
+            }
+        }
+        threshold_ = 0;
+        while (build_levels_()) {
+            blocking_flow_();
+        }
+    }
+};
+
+// Synchronous parallel push-relabel. Every round has three steps separated by barriers: the
+// active vertices push with the heights fixed at the start of the round, those still holding
+// excess relabel against the settled residual capacities, and the excess sent to each vertex
+// (collected with atomic additions) is applied to form the next active set. Within a step no two
+// vertices push over the same pair of residual edges, as each would have to be one above the
+// other, and a vertex looks at the residual capacity of an edge only once the heights make it
+// admissible; so the residual capacities need no atomics, and a round does not depend on the
+// schedule: for integral capacities the flow, not only its value, is the same for any number of
+// threads (floating-point sums depend on the order of the additions). Heights are
+// recomputed by a level-synchronous parallel BFS from the sink once enough relabelling work has
+// piled up. The solver works on its own copy of the residual capacities and writes the flow back.
+template<class Capacity>
+class ParallelPushRelabel : public MaxFlowAlgorithm<Capacity> {
+  private:
+
+    using Traits = CapacityTraits<Capacity>;
+    using MaxFlowAlgorithm<Capacity>::network_;
+    using MaxFlowAlgorithm<Capacity>::flow_;
+    using MaxFlowAlgorithm<Capacity>::statistics_;
+
+    constexpr static size_t GLOBAL_RELABEL_ALPHA = 6;
+    constexpr static size_t RELABEL_WORK = 12;
+
+    // counters of one thread, a cache line each so that counting does not make the threads share lines
+    struct alignas(64) ThreadStatistics {
+        size_t pushes, relabels;
+    };
+
+    // threads block here until all of them arrive
+    class Barrier {
+      private:
+
+        size_t              threads_cnt_;
+        std::atomic<size_t> waiting_,
+                            generation_;
+
+      public:
+
+        explicit Barrier(size_t _threads_cnt)
+                : threads_cnt_(_threads_cnt)
+                , waiting_(0)
+                , generation_(0)
+        {}
+
+        void wait() {
+            size_t generation = generation_.load(std::memory_order_acquire);
+            if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == threads_cnt_) {
+                waiting_.store(0, std::memory_order_relaxed);
+                generation_.fetch_add(1, std::memory_order_release);
+                return;
+            }
+            while (generation_.load(std::memory_order_acquire) == generation) {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    size_t                             threads_cnt_,
+                                       vertices_cnt_,
+                                       active_cnt_,
+                                       frontier_cnt_,
+                                       work_limit_;
+    std::vector<size_t>                height_,
+                                       new_height_,
+                                       current_arc_,
+                                       active_,
+                                       frontier_;
+    std::vector<Capacity>              excess_,
+                                       residual_;
+    std::vector<std::atomic<Capacity>> incoming_;
+    std::vector<std::atomic<char>>     queued_,
+                                       claimed_;
+    std::vector<std::vector<size_t>>   queued_local_,
+                                       frontier_local_;
+    std::vector<ThreadStatistics>      thread_statistics_;
+    std::atomic<size_t>                work_;
+    std::unique_ptr<Barrier>           barrier_;
+
+    size_t head_of_(size_t edge) { return network_->edge_at(edge).to(); }
+    size_t reverse_of_(size_t edge) { return network_->edge_at(edge).reverse().position(); }
+
+    // the part of [0, size) that thread_id handles
+    size_t range_begin_(size_t thread_id, size_t size) const { return size * thread_id / threads_cnt_; }
+    size_t range_end_(size_t thread_id, size_t size) const { return size * (thread_id + 1) / threads_cnt_; }
+
+    // atomic floating-point types have no fetch_add before C++20
+    static void add_(std::atomic<Capacity>& target, Capacity value) {
+        if constexpr (std::is_integral<Capacity>::value) {
+            target.fetch_add(value, std::memory_order_relaxed);
+            return;
+        }
+        Capacity current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {}
+    }
+
+    void enqueue_(size_t vertex_id, size_t thread_id) {
+        if (vertex_id != network_->source() && vertex_id != network_->sink() &&
+            !queued_[vertex_id].exchange(1, std::memory_order_relaxed)) {
+            queued_local_[thread_id].push_back(vertex_id);
+        }
+    }
+
+    // concatenates the local lists of all threads into target in thread order and empties them
+    void gather_(size_t thread_id, std::vector<std::vector<size_t>>& local,
+                 std::vector<size_t>& target, size_t& target_cnt) {
+        barrier_->wait();
+        size_t offset = 0,
+               total = 0;
+        for (size_t other_id = 0; other_id < threads_cnt_; ++other_id) {
+            if (other_id < thread_id) offset += local[other_id].size();
+            total += local[other_id].size();
+        }
+        std::copy(local[thread_id].begin(), local[thread_id].end(), target.begin() + offset);
+        if (thread_id == 0) target_cnt = total;
+        barrier_->wait();
+        local[thread_id].clear();
+    }
+
+    void global_relabel_(size_t thread_id) {
+        for (size_t vertex_id = range_begin_(thread_id, vertices_cnt_);
+             vertex_id < range_end_(thread_id, vertices_cnt_); ++vertex_id) {
+            height_[vertex_id] = vertices_cnt_;
+            current_arc_[vertex_id] = network_->first_edge(vertex_id);
+            claimed_[vertex_id].store(0, std::memory_order_relaxed);
+        }
+        barrier_->wait();
+        if (thread_id == 0) {
+            ++statistics_.phases;
+            work_.store(0, std::memory_order_relaxed);
+            height_[network_->sink()] = 0;
+            claimed_[network_->sink()].store(1, std::memory_order_relaxed);
+            claimed_[network_->source()].store(1, std::memory_order_relaxed);
+            frontier_[0] = network_->sink();
+            frontier_cnt_ = 1;
+        }
+        barrier_->wait();
+        while (frontier_cnt_ > 0) {
+            for (size_t index = range_begin_(thread_id, frontier_cnt_);
+                 index < range_end_(thread_id, frontier_cnt_); ++index) {
+                size_t vertex_id = frontier_[index];
+                for (size_t edge = network_->first_edge(vertex_id); edge < network_->first_edge(vertex_id + 1); ++edge) {
+                    size_t from = head_of_(edge);
+                    if (Traits::positive(residual_[reverse_of_(edge)]) && !claimed_[from].load(std::memory_order_relaxed) &&
+                        !claimed_[from].exchange(1, std::memory_order_relaxed)) {
+                        height_[from] = height_[vertex_id] + 1;
+                        frontier_local_[thread_id].push_back(from);
+                    }
+                }
+            }
+            gather_(thread_id, frontier_local_, frontier_, frontier_cnt_);
+        }
+    }
+
+    void push_(size_t vertex_id, size_t thread_id) {
+        size_t end = network_->first_edge(vertex_id + 1);
+        for (size_t& edge = current_arc_[vertex_id]; edge < end && Traits::positive(excess_[vertex_id]); ++edge) {
+            size_t to = head_of_(edge);
+            if (height_[vertex_id] != height_[to] + 1 || !Traits::positive(residual_[edge])) continue;
+            Capacity push_value = std::min(excess_[vertex_id], residual_[edge]);
+            residual_[edge] -= push_value;
+            residual_[reverse_of_(edge)] += push_value;
+            excess_[vertex_id] -= push_value;
+            add_(incoming_[to], push_value);
+            ++thread_statistics_[thread_id].pushes;
+            enqueue_(to, thread_id);
+            if (Traits::positive(residual_[edge])) break;
+        }
+    }
+
+    void relabel_(size_t vertex_id, size_t thread_id) {
+        size_t minimal_height = vertices_cnt_,
+               begin = network_->first_edge(vertex_id),
+               end = network_->first_edge(vertex_id + 1);
+        for (size_t edge = begin; edge < end; ++edge) {
+            if (Traits::positive(residual_[edge])) {
+                minimal_height = std::min(minimal_height, height_[head_of_(edge)] + 1);
+            }
+        }
+        new_height_[vertex_id] = minimal_height;
+        ++thread_statistics_[thread_id].relabels;
+        current_arc_[vertex_id] = begin;
+        work_.fetch_add(end - begin + RELABEL_WORK, std::memory_order_relaxed);
+    }
+
+    // the queued vertices of this thread take their incoming excess; the live ones become active
+    void collect_active_(size_t thread_id) {
+        std::vector<size_t>& queued = queued_local_[thread_id];
+        size_t kept = 0;
+        for (size_t vertex_id : queued) {
+            queued_[vertex_id].store(0, std::memory_order_relaxed);
+            excess_[vertex_id] += incoming_[vertex_id].exchange(0, std::memory_order_relaxed);
+            if (Traits::positive(excess_[vertex_id]) && height_[vertex_id] < vertices_cnt_) {
+                queued[kept++] = vertex_id;
+            }
+        }
+        queued.resize(kept);
+        gather_(thread_id, queued_local_, active_, active_cnt_);
+    }
+
+    void worker_(size_t thread_id) {
+        global_relabel_(thread_id);
+        collect_active_(thread_id);
+        while (active_cnt_ > 0) {
+            size_t begin = range_begin_(thread_id, active_cnt_),
+                   end = range_end_(thread_id, active_cnt_);
+            for (size_t index = begin; index < end; ++index) {
+                if (height_[active_[index]] < vertices_cnt_) push_(active_[index], thread_id);
+            }
+            barrier_->wait();
+            for (size_t index = begin; index < end; ++index) {
+                if (Traits::positive(excess_[active_[index]]) && height_[active_[index]] < vertices_cnt_) relabel_(active_[index], thread_id);
+            }
+            barrier_->wait();
+            for (size_t index = begin; index < end; ++index) {
+                size_t vertex_id = active_[index];
+                if (Traits::positive(excess_[vertex_id]) && height_[vertex_id] < vertices_cnt_) {
+                    height_[vertex_id] = new_height_[vertex_id];
+                    if (height_[vertex_id] < vertices_cnt_) enqueue_(vertex_id, thread_id);
+                }
+            }
+            barrier_->wait();
+            collect_active_(thread_id);
+            if (work_.load(std::memory_order_relaxed) > work_limit_) {
+                barrier_->wait();
+                global_relabel_(thread_id);
+            }
+        }
+    }
+
+  public:
+
+    explicit ParallelPushRelabel(size_t _threads_cnt = std::thread::hardware_concurrency())
+            : threads_cnt_(std::max<size_t>(_threads_cnt, 1))
+    {}
+
+    void set_threads(size_t threads_cnt) { threads_cnt_ = std::max<size_t>(threads_cnt, 1); }
+
+    size_t memory() const override {
+        size_t bytes = MaxFlowAlgorithm<Capacity>::memory() + this->bytes_(height_) + this->bytes_(new_height_) +
+                       this->bytes_(current_arc_) + this->bytes_(active_) + this->bytes_(frontier_) +
+                       this->bytes_(excess_) + this->bytes_(residual_) + this->bytes_(incoming_) +
+                       this->bytes_(queued_) + this->bytes_(claimed_) + this->bytes_(queued_local_) +
+                       this->bytes_(frontier_local_) + this->bytes_(thread_statistics_);
+        for (size_t thread_id = 0; thread_id < queued_local_.size(); ++thread_id) {
+            bytes += this->bytes_(queued_local_[thread_id]) + this->bytes_(frontier_local_[thread_id]);
+        }
+        return bytes;
+    }
+
+    void run() override {
+        vertices_cnt_ = network_->vertices_cnt();
+        size_t edges_cnt = network_->edges_cnt();
+        work_limit_ = GLOBAL_RELABEL_ALPHA * vertices_cnt_ + edges_cnt;
+        network_->discard_flow();
+        residual_.resize(edges_cnt);
+        for (size_t edge = 0; edge < edges_cnt; ++edge) {
+            residual_[edge] = network_->edge_at(edge).capacity();
+        }
+        height_.assign(vertices_cnt_, vertices_cnt_);
+        new_height_.assign(vertices_cnt_, vertices_cnt_);
+        current_arc_.assign(vertices_cnt_, 0);
+        active_.assign(vertices_cnt_, 0);
+        frontier_.assign(vertices_cnt_, 0);
+        excess_.assign(vertices_cnt_, 0);
+        std::vector<std::atomic<Capacity>>(vertices_cnt_).swap(incoming_);
+        std::vector<std::atomic<char>>(vertices_cnt_).swap(queued_);
+        std::vector<std::atomic<char>>(vertices_cnt_).swap(claimed_);
+        for (size_t vertex_id = 0; vertex_id < vertices_cnt_; ++vertex_id) {
+            incoming_[vertex_id].store(0, std::memory_order_relaxed);
+            queued_[vertex_id].store(0, std::memory_order_relaxed);
+        }
+        queued_local_.assign(threads_cnt_, {});
+        frontier_local_.assign(threads_cnt_, {});
+        thread_statistics_.assign(threads_cnt_, {0, 0});
+        barrier_.reset(new Barrier(threads_cnt_));
+
+        size_t source = network_->source();
+        for (size_t edge = network_->first_edge(source); edge < network_->first_edge(source + 1); ++edge) {
+            Capacity push_value = residual_[edge];
+            residual_[edge] = 0;
+            residual_[reverse_of_(edge)] += push_value;
+            add_(incoming_[head_of_(edge)], push_value);
+            if (Traits::positive(push_value)) enqueue_(head_of_(edge), 0);
+        }
+
+        std::vector<std::thread> workers;
+        for (size_t thread_id = 1; thread_id < threads_cnt_; ++thread_id) {
+            workers.emplace_back(&ParallelPushRelabel::worker_, this, thread_id);
+        }
+        worker_(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const ThreadStatistics& counted : thread_statistics_) {
+            statistics_.pushes += counted.pushes;
+            statistics_.relabels += counted.relabels;
+        }
+
+        for (size_t edge = 0; edge < edges_cnt; ++edge) {
+            typename ResidualNetwork<Capacity>::Edge current = network_->edge_at(edge);
+            current.flow() = current.capacity() - residual_[edge];
+        }
+        flow_ = incoming_[network_->sink()].load(std::memory_order_relaxed);
+    }
+};
+
+// Boykov-Kolmogorov: one search tree grows from the source over residual edges and another from
+// the sink over reversed ones until they touch, which gives an augmenting path. The trees are kept
+// between augmentations: a vertex cut off by a saturated edge looks for a new parent in its own tree
+// and leaves it only if there is none. Kolmogorov's timestamps keep the parents close to the root.
+// Made for the short paths of vision grids, where most vertices hang right off a terminal.
+template<class Capacity>
+class BoykovKolmogorov : public MaxFlowAlgorithm<Capacity> {
+  private:
+
+    using Network = ResidualNetwork<Capacity>;
+    using Traits = CapacityTraits<Capacity>;
+    using MaxFlowAlgorithm<Capacity>::network_;
+    using MaxFlowAlgorithm<Capacity>::flow_;
+    using MaxFlowAlgorithm<Capacity>::statistics_;
+
+    enum TREE : char {
+        FREE,
+        SOURCE_TREE,
+        SINK_TREE
+    };
+
+    // the parent of a vertex in a tree is given by the residual edge from the vertex to it
+    constexpr static size_t ROOT   = Network::NONE,
+                            ORPHAN = Network::NONE - 1;
+
+    std::vector<char>   tree_,
+                        active_;
+    std::vector<size_t> parent_,
+    // the augmentation after which distance_ was last known to be the distance to the root
+                        timestamp_,
+                        distance_;
+    // vertices to grow the trees from, taken from active_queue_ and added to next_active_
+    std::vector<size_t> active_queue_,
+                        next_active_,
+                        orphans_;
+    size_t              active_head_,
+                        time_;
+
+    void activate_(size_t vertex_id) {
+        if (active_[vertex_id]) return;
+        active_[vertex_id] = true;
+        next_active_.push_back(vertex_id);
+    }
+
+    size_t next_active_vertex_() {
+        while (true) {
+            if (active_head_ == active_queue_.size()) {
+                if (next_active_.empty()) return Network::NONE;
+                active_queue_.swap(next_active_);
+                next_active_.clear();
+                active_head_ = 0;
+            }
+            size_t vertex_id = active_queue_[active_head_++];
+            active_[vertex_id] = false;
+            if (tree_[vertex_id] != FREE) return vertex_id;
+        }
+    }
+
+    // The residual edge the tree of a vertex would carry flow over between the vertex and the head
+    // of edge, one of the vertex's own: flow goes away from the source in the source tree and
+    // towards the sink in the sink tree, so which way depends on whether the head is a child
+    // (growing) or a parent (adopting).
+    typename Network::Edge to_child_(size_t edge, char tree) {
+        auto current = network_->edge_at(edge);
+        return (tree == SOURCE_TREE ? current : current.reverse());
+    }
+
+    typename Network::Edge to_parent_(size_t edge, char tree) {
+        auto current = network_->edge_at(edge);
+        return (tree == SOURCE_TREE ? current.reverse() : current);
+    }
+
+    // adds the free neighbours of vertex_id to its tree; returns the edge from the source tree to
+    // the sink tree once they touch, NONE if they do not
+    size_t grow_(size_t vertex_id) {
+        char tree = tree_[vertex_id];
+        size_t end = network_->first_edge(vertex_id + 1);
+        for (size_t edge = network_->first_edge(vertex_id); edge < end; ++edge) {
+            auto child = to_child_(edge, tree);
+            if (child.saturated()) continue;
+            size_t to = network_->edge_at(edge).to();
+            if (tree_[to] == FREE) {
+                tree_[to] = tree;
+                parent_[to] = network_->edge_at(edge).reverse().position();
+                timestamp_[to] = timestamp_[vertex_id];
+                distance_[to] = distance_[vertex_id] + 1;
+                activate_(to);
+            } else if (tree_[to] != tree) {
+                return child.position();
+            } else if (timestamp_[to] <= timestamp_[vertex_id] && distance_[to] > distance_[vertex_id]) {
+                // a shorter way to the root
+                parent_[to] = network_->edge_at(edge).reverse().position();
+                timestamp_[to] = timestamp_[vertex_id];
+                distance_[to] = distance_[vertex_id] + 1;
+            }
+        }
+        return Network::NONE;
+    }
+
+    void push_(typename Network::Edge edge, Capacity value) {
+        edge.flow() += value;
+        edge.reverse().flow() -= value;
+    }
+
+    // pushes the bottleneck along source ... -> bridge -> ... sink; vertices whose edge to the
+    // parent gets saturated become orphans
+    void augment_along_(size_t bridge_edge) {
+        auto bridge = network_->edge_at(bridge_edge);
+        Capacity push_value = bridge.residual_capacity();
+        for (size_t vertex_id : {bridge.from(), bridge.to()}) {
+            for (; parent_[vertex_id] != ROOT; vertex_id = network_->edge_at(parent_[vertex_id]).to()) {
+                push_value = std::min(push_value,
+                                      to_parent_(parent_[vertex_id], tree_[vertex_id]).residual_capacity());
+            }
+        }
+        push_(bridge, push_value);
+        for (size_t vertex_id : {bridge.from(), bridge.to()}) {
+            while (parent_[vertex_id] != ROOT) {
+                auto up = to_parent_(parent_[vertex_id], tree_[vertex_id]);
+                size_t parent = network_->edge_at(parent_[vertex_id]).to();
+                push_(up, push_value);
+                if (up.saturated()) {
+                    parent_[vertex_id] = ORPHAN;
+                    orphans_.push_back(vertex_id);
+                }
+                vertex_id = parent;
+            }
+        }
+        flow_ += push_value;
+        ++statistics_.pushes;
+    }
+
+    // the distance from vertex_id to the root of its tree, NONE if an orphan cuts it off; the
+    // distances found on the way are stamped with the current time
+    size_t distance_to_root_(size_t vertex_id) {
+        size_t distance = 0,
+               ancestor = vertex_id;
+        while (timestamp_[ancestor] != time_) {
+            if (parent_[ancestor] == ORPHAN) return Network::NONE;
+            if (parent_[ancestor] == ROOT) {
+                timestamp_[ancestor] = time_;
+                distance_[ancestor] = 0;
+                break;
+            }
+            ++distance;
+            ancestor = network_->edge_at(parent_[ancestor]).to();
+        }
+        distance += distance_[ancestor];
+        size_t result = distance;
+        for (ancestor = vertex_id; timestamp_[ancestor] != time_;
+             ancestor = network_->edge_at(parent_[ancestor]).to()) {
+            timestamp_[ancestor] = time_;
+            distance_[ancestor] = distance--;
+        }
+        return result;
+    }
+
+    // finds the orphan the closest new parent in its tree, or frees it, orphaning its children
+    void adopt_(size_t vertex_id) {
+        ++statistics_.relabels;
+        char tree = tree_[vertex_id];
+        size_t begin = network_->first_edge(vertex_id),
+               end = network_->first_edge(vertex_id + 1),
+               best_edge = Network::NONE,
+               best_distance = Network::NONE;
+        for (size_t edge = begin; edge < end; ++edge) {
+            size_t to = network_->edge_at(edge).to();
+            if (tree_[to] != tree || to_parent_(edge, tree).saturated()) continue;
+            size_t distance = distance_to_root_(to);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best_edge = edge;
+            }
+        }
+        if (best_edge != Network::NONE) {
+            parent_[vertex_id] = best_edge;
+            timestamp_[vertex_id] = time_;
+            distance_[vertex_id] = best_distance + 1;
+            return;
+        }
+        tree_[vertex_id] = FREE;
+        for (size_t edge = begin; edge < end; ++edge) {
+            size_t to = network_->edge_at(edge).to();
+            if (tree_[to] != tree) continue;
+            // a neighbour that could take it back into the tree grows again
+            if (!to_parent_(edge, tree).saturated()) activate_(to);
+            if (parent_[to] != ROOT && parent_[to] != ORPHAN && network_->edge_at(parent_[to]).to() == vertex_id) {
+                parent_[to] = ORPHAN;
+                orphans_.push_back(to);
+            }
+        }
+    }
+
+    // adds augmenting paths to the flow in the network until it is maximum
+    void augment_() {
+        size_t vertices_cnt = network_->vertices_cnt();
+        tree_.assign(vertices_cnt, FREE);
+        active_.assign(vertices_cnt, false);
+        parent_.assign(vertices_cnt, ORPHAN);
+        timestamp_.assign(vertices_cnt, 0);
+        distance_.assign(vertices_cnt, 0);
+        active_queue_.clear();
+        next_active_.clear();
+        orphans_.clear();
+        active_head_ = 0;
+        time_ = 0;
+        for (size_t terminal : {network_->source(), network_->sink()}) {
+            tree_[terminal] = (terminal == network_->source() ? SOURCE_TREE : SINK_TREE);
+            parent_[terminal] = ROOT;
+            activate_(terminal);
+        }
+        // a vertex keeps growing its tree for as long as that finds paths
+        size_t vertex_id = Network::NONE;
+        while (true) {
+            if (vertex_id == Network::NONE || tree_[vertex_id] == FREE) {
+                vertex_id = next_active_vertex_();
+                if (vertex_id == Network::NONE) break;
+            }
+            size_t bridge = grow_(vertex_id);
+            if (bridge == Network::NONE) {
+                vertex_id = Network::NONE;
+                continue;
+            }
+            ++time_;
+            augment_along_(bridge);
+            for (size_t head = 0; head < orphans_.size(); ++head) {
+                adopt_(orphans_[head]);
+            }
+            orphans_.clear();
+        }
+    }
+
+  public:
+
+    size_t memory() const override {
+        return MaxFlowAlgorithm<Capacity>::memory() + this->bytes_(tree_) + this->bytes_(active_) +
+               this->bytes_(parent_) + this->bytes_(timestamp_) + this->bytes_(distance_) +
+               this->bytes_(active_queue_) + this->bytes_(next_active_) + this->bytes_(orphans_);
+    }
+
+    void run() override {
+        network_->discard_flow();
+        flow_ = 0;
+        augment_();
+    }
+
+    // the flow is kept, the trees are grown anew
+    void resolve() override {
+        this->restore_flow_();
+        augment_();
+    }
+};
+
+// A flow of maximum value, and of minimum cost among those, in a network with costs.
+template<class Capacity, class Cost>
+class MinCostFlowAlgorithm {
+  public:
+
+    // pushes, relabels and phases as the solvers below define them
+    using Statistics = typename MaxFlowAlgorithm<Capacity>::Statistics;
+
+  protected:
+
+    using Network = ResidualNetwork<Capacity, Cost>;
+    using Traits = CapacityTraits<Capacity>;
+
+    Network*   network_;
+    Capacity   flow_;
+    Cost       cost_;
+    Statistics statistics_ = {0, 0, 0};
+
+    template<class T>
+    static size_t bytes_(const std::vector<T>& values) { return values.capacity() * sizeof(T); }
+
+    // the cost of the flow the network holds
+    Cost count_cost_() {
+        Cost cost = 0;
+        for (size_t position = 0; position < network_->first_edge(network_->vertices_cnt()); ++position) {
+            auto edge = network_->edge_at(position);
+            if (Traits::positive(edge.flow())) cost += static_cast<Cost>(edge.flow()) * edge.cost();
+        }
+        return cost;
+    }
+
+  public:
+
+    void init(Network* _network) {
+        network_ = _network;
+        flow_ = 0;
+        cost_ = 0;
+        statistics_ = {0, 0, 0};
+    }
+
+    Capacity flow() const { return flow_; }
+
+    Cost cost() const { return cost_; }
+
+    const Statistics& statistics() const { return statistics_; }
+
+    // bytes held by the solver's own arrays, not counting the network
+    virtual size_t memory() const { return 0; }
+
+    virtual void run() = 0;
+};
+
+// Successive shortest paths: augments along a cheapest path until the sink is out of reach.
+// Dijkstra finds the paths on costs reduced by Johnson potentials, which stay non-negative on
+// every residual edge; Bellman-Ford sets the potentials up when there are negative costs. The
+// network must not have a cycle of negative cost. A push is an augmenting path, a phase a search.
+template<class Capacity, class Cost>
+class SuccessiveShortestPaths : public MinCostFlowAlgorithm<Capacity, Cost> {
+  private:
+
+    using Network = ResidualNetwork<Capacity, Cost>;
+    using Traits = CapacityTraits<Capacity>;
+    using MinCostFlowAlgorithm<Capacity, Cost>::network_;
+    using MinCostFlowAlgorithm<Capacity, Cost>::flow_;
+    using MinCostFlowAlgorithm<Capacity, Cost>::cost_;
+    using MinCostFlowAlgorithm<Capacity, Cost>::statistics_;
+
+    constexpr static Cost UNREACHED = std::numeric_limits<Cost>::max() / 2;
+
+    std::vector<Cost>                    potential_,
+                                         distance_;
+    std::vector<size_t>                  path_edge_,
+                                         queue_;
+    std::vector<char>                    queued_;
+    // a min-heap of (distance, vertex); entries whose distance has since dropped are skipped
+    std::vector<std::pair<Cost, size_t>> heap_;
+
+    bool has_negative_costs_() {
+        for (size_t position = 0; position < network_->first_edge(network_->vertices_cnt()); ++position) {
+            auto edge = network_->edge_at(position);
+            if (!edge.saturated() && edge.cost() < 0) return true;
+        }
+        return false;
+    }
+
+    // Bellman-Ford with a queue from the source; vertices it cannot reach keep potential 0, and
+    // no path from the source ever leads to them
+    void init_potentials_() {
+        size_t vertices_cnt = network_->vertices_cnt();
+        potential_.assign(vertices_cnt, 0);
+        if (!has_negative_costs_()) return;
+        distance_.assign(vertices_cnt, UNREACHED);
+        queued_.assign(vertices_cnt, false);
+        distance_[network_->source()] = 0;
+        queue_.assign(1, network_->source());
+        for (size_t head = 0; head < queue_.size(); ++head) {
+            size_t vertex_id = queue_[head];
+            queued_[vertex_id] = false;
+            size_t end = network_->first_edge(vertex_id + 1);
+            for (size_t position = network_->first_edge(vertex_id); position < end; ++position) {
+                auto edge = network_->edge_at(position);
+                if (edge.saturated() || distance_[vertex_id] + edge.cost() >= distance_[edge.to()]) continue;
+                distance_[edge.to()] = distance_[vertex_id] + edge.cost();
+                if (!queued_[edge.to()]) {
+                    queued_[edge.to()] = true;
+                    queue_.push_back(edge.to());
+                }
+            }
+        }
+        for (size_t vertex_id = 0; vertex_id < vertices_cnt; ++vertex_id) {
+            if (distance_[vertex_id] != UNREACHED) potential_[vertex_id] = distance_[vertex_id];
+        }
+    }
+
+    // Dijkstra on reduced costs, stopped once the sink is settled; false if it cannot be reached
+    bool find_path_() {
+        ++statistics_.phases;
+        size_t sink = network_->sink();
+        distance_.assign(network_->vertices_cnt(), UNREACHED);
+        distance_[network_->source()] = 0;
+        heap_.assign(1, {0, network_->source()});
+        while (!heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<>());
+            auto [distance, vertex_id] = heap_.back();
+            heap_.pop_back();
+            if (distance != distance_[vertex_id]) continue;
+            if (vertex_id == sink) break;
+            size_t end = network_->first_edge(vertex_id + 1);
+            for (size_t position = network_->first_edge(vertex_id); position < end; ++position) {
+                auto edge = network_->edge_at(position);
+                if (edge.saturated()) continue;
+                size_t to = edge.to();
+                Cost through = distance + edge.cost() + potential_[vertex_id] - potential_[to];
+                if (through < distance_[to]) {
+                    distance_[to] = through;
+                    path_edge_[to] = position;
+                    heap_.emplace_back(through, to);
+                    std::push_heap(heap_.begin(), heap_.end(), std::greater<>());
+                }
+            }
+        }
+        if (distance_[sink] == UNREACHED) return false;
+        // vertices not settled are at least as far as the sink, so reduced costs stay non-negative
+        for (size_t vertex_id = 0; vertex_id < network_->vertices_cnt(); ++vertex_id) {
+            potential_[vertex_id] += std::min(distance_[vertex_id], distance_[sink]);
+        }
+        return true;
+    }
+
+    void augment_() {
+        Capacity push_value = Traits::INF;
+        for (size_t vertex_id = network_->sink(); vertex_id != network_->source();) {
+            auto edge = network_->edge_at(path_edge_[vertex_id]);
+            push_value = std::min(push_value, edge.residual_capacity());
+            vertex_id = edge.from();
+        }
+        Cost path_cost = 0;
+        for (size_t vertex_id = network_->sink(); vertex_id != network_->source();) {
+            auto edge = network_->edge_at(path_edge_[vertex_id]);
+            edge.flow() += push_value;
+            edge.reverse().flow() -= push_value;
+            path_cost += edge.cost();
+            vertex_id = edge.from();
+        }
+        flow_ += push_value;
+        cost_ += static_cast<Cost>(push_value) * path_cost;
+        ++statistics_.pushes;
+    }
+
+  public:
+
+    size_t memory() const override {
+        return this->bytes_(potential_) + this->bytes_(distance_) + this->bytes_(path_edge_) +
+               this->bytes_(queue_) + this->bytes_(queued_) + this->bytes_(heap_);
+    }
+
+    void run() override {
+        network_->discard_flow();
+        flow_ = 0;
+        cost_ = 0;
+        path_edge_.assign(network_->vertices_cnt(), Network::NONE);
+        init_potentials_();
+        while (find_path_()) {
+            augment_();
+        }
+    }
+};
+
+// Cost scaling (Goldberg and Tarjan): Dinic finds a maximum flow, and push-relabel on prices then
+// turns it into a cheapest one. Costs are multiplied by the number of vertices, and each phase
+// (refine) makes the flow epsilon-optimal, with no residual edge of reduced cost below -epsilon,
+// for an epsilon ALPHA times smaller than before; at 1 the flow is optimal. Unlike successive
+// shortest paths it copes with cycles of negative cost. Costs must be integral.
+template<class Capacity, class Cost>
+class CostScaling : public MinCostFlowAlgorithm<Capacity, Cost> {
+    static_assert(std::is_integral<Cost>::value, "cost scaling needs integral costs");
+
+  private:
+
+    using Network = ResidualNetwork<Capacity, Cost>;
+    using Traits = CapacityTraits<Capacity>;
+    using MinCostFlowAlgorithm<Capacity, Cost>::network_;
+    using MinCostFlowAlgorithm<Capacity, Cost>::flow_;
+    using MinCostFlowAlgorithm<Capacity, Cost>::cost_;
+    using MinCostFlowAlgorithm<Capacity, Cost>::statistics_;
+
+    constexpr static Cost ALPHA = 8;
+
+    Cost                  scale_;
+    std::vector<Cost>     price_;
+    std::vector<Capacity> excess_;
+    // vertices whose excess turned positive, and those being discharged
+    std::vector<size_t>   current_arc_,
+                          active_,
+                          discharged_;
+    Dinic<Capacity>       max_flow_;
+
+    Cost reduced_cost_(size_t vertex_id, const typename Network::Edge& edge) const {
+        return edge.cost() * scale_ + price_[vertex_id] - price_[edge.to()];
+    }
+
+    void push_(size_t vertex_id, typename Network::Edge edge, Capacity value) {
+        edge.flow() += value;
+        edge.reverse().flow() -= value;
+        excess_[vertex_id] -= value;
+        // a vertex is queued whenever its excess turns positive
+        bool had_excess = Traits::positive(excess_[edge.to()]);
+        excess_[edge.to()] += value;
+        if (!had_excess && Traits::positive(excess_[edge.to()])) active_.push_back(edge.to());
+        ++statistics_.pushes;
+    }
+
+    // lowers the price just enough for some residual edge to get reduced cost -epsilon
+    void relabel_(size_t vertex_id, Cost epsilon) {
+        ++statistics_.relabels;
+        Cost highest = std::numeric_limits<Cost>::min();
+        size_t end = network_->first_edge(vertex_id + 1);
+        for (size_t position = network_->first_edge(vertex_id); position < end; ++position) {
+            auto edge = network_->edge_at(position);
+            if (!edge.saturated()) highest = std::max(highest, price_[edge.to()] - edge.cost() * scale_);
+        }
+        price_[vertex_id] = highest - epsilon;
+    }
+
+    void discharge_(size_t vertex_id, Cost epsilon) {
+        size_t begin = network_->first_edge(vertex_id),
+               end = network_->first_edge(vertex_id + 1);
+        while (Traits::positive(excess_[vertex_id])) {
+            if (current_arc_[vertex_id] == end) {
+                relabel_(vertex_id, epsilon);
+                current_arc_[vertex_id] = begin;
+            }
+            auto edge = network_->edge_at(current_arc_[vertex_id]);
+            if (!edge.saturated() && reduced_cost_(vertex_id, edge) < 0) {
+                push_(vertex_id, edge, std::min(excess_[vertex_id], edge.residual_capacity()));
+                if (edge.saturated()) ++current_arc_[vertex_id];
+            } else {
+                ++current_arc_[vertex_id];
+            }
+        }
+    }
+
+    // saturates every residual edge of negative reduced cost, which makes the flow 0-optimal but
+    // leaves excesses and deficits, and pushes the excesses on to the deficits
+    void refine_(Cost epsilon) {
+        ++statistics_.phases;
+        size_t vertices_cnt = network_->vertices_cnt();
+        excess_.assign(vertices_cnt, 0);
+        active_.clear();
+        for (size_t vertex_id = 0; vertex_id < vertices_cnt; ++vertex_id) {
+            size_t end = network_->first_edge(vertex_id + 1);
+            for (size_t position = network_->first_edge(vertex_id); position < end; ++position) {
+                auto edge = network_->edge_at(position);
+                if (!edge.saturated() && reduced_cost_(vertex_id, edge) < 0) {
+                    push_(vertex_id, edge, edge.residual_capacity());
+                }
+            }
+            current_arc_[vertex_id] = network_->first_edge(vertex_id);
+        }
+        while (!active_.empty()) {
+            discharged_.swap(active_);
+            active_.clear();
+            for (size_t vertex_id : discharged_) {
+                discharge_(vertex_id, epsilon);
+            }
+        }
+    }
+
+  public:
+
+    size_t memory() const override {
+        return this->bytes_(price_) + this->bytes_(excess_) + this->bytes_(current_arc_) + this->bytes_(active_) +
+               this->bytes_(discharged_) + max_flow_.memory();
+    }
+
+    void run() override {
+        network_->discard_flow();
+        max_flow_.init(network_);
+        max_flow_.run();
+        flow_ = max_flow_.flow();
+        size_t vertices_cnt = network_->vertices_cnt();
+        scale_ = static_cast<Cost>(vertices_cnt);
+        price_.assign(vertices_cnt, 0);
+        current_arc_.resize(vertices_cnt);
+        Cost epsilon = 0;
+        for (size_t position = 0; position < network_->first_edge(vertices_cnt); ++position) {
+            epsilon = std::max(epsilon, network_->edge_at(position).cost() * scale_);
+        }
+        while (epsilon > 1) {
+            epsilon = std::max<Cost>(1, epsilon / ALPHA);
+            refine_(epsilon);
+        }
+        cost_ = this->count_cost_();
+    }
+};
+
+struct Data {
+    size_t topic_cnt;
+    std::vector<long long> values;
+    // sorted, without repeats
+    std::vector<std::vector<size_t>> dependencies;
+
+    void read(std::istream& in) {
+        in >> topic_cnt;
+        values.resize(topic_cnt);
+        dependencies.resize(topic_cnt);
+        for (auto& value : values) {
+            in >> value;
+        }
+        for (size_t topic_id = 0; topic_id < topic_cnt; ++topic_id) {
+            size_t dependencies_cnt;
+            in >> dependencies_cnt;
+            dependencies[topic_id].resize(dependencies_cnt);
+            for (auto& required_topic_id : dependencies[topic_id]) {
+                in >> required_topic_id;
+                --required_topic_id;
+            }
+            std::sort(dependencies[topic_id].begin(), dependencies[topic_id].end());
+            dependencies[topic_id].erase(std::unique(dependencies[topic_id].begin(), dependencies[topic_id].end()),
+                                         dependencies[topic_id].end());
+        }
+    }
+
+    long long positive_sum() const {
+        long long sum = 0;
+        for (long long value : values) {
+            sum += std::max(value, 0LL);
+        }
+        return sum;
+    }
+
+    // the total capacity of the network solve builds, which bounds every flow, excess and potential
+    double capacity_sum() const {
+        double sum = 0,
+               infinity = static_cast<double>(positive_sum() + 1);
+        for (size_t topic_id = 0; topic_id < topic_cnt; ++topic_id) {
+            sum += std::abs(static_cast<double>(values[topic_id]));
+            sum += static_cast<double>(dependencies[topic_id].size()) * infinity;
+        }
+        return sum;
+    }
+};
+
+// Topics on a cycle of dependencies are either all chosen or none, so every strongly connected
+// component of the dependency graph is contracted into one topic worth their total value. The
+// component of each topic goes to component; dependencies inside a component are dropped and the
+// ones between components are kept once, sorted as Data keeps them. Tarjan closes a component only
+// after everything it requires, so a topic of the result requires only topics with smaller ids.
+Data contract_cycles(const Data& data, std::vector<size_t>& component) {
+    const size_t NONE = std::numeric_limits<size_t>::max();
+    // iterative Tarjan: order of discovery, the lowest order reachable and the next dependency to visit
+    std::vector<size_t> order(data.topic_cnt, NONE),
+                        lowlink(data.topic_cnt),
+                        next_dependency(data.topic_cnt, 0);
+    std::vector<size_t> call_stack,
+                        component_stack;
+    component.assign(data.topic_cnt, NONE);
+    size_t visited_cnt   = 0,
+           component_cnt = 0;
+    for (size_t root_id = 0; root_id < data.topic_cnt; ++root_id) {
+        if (order[root_id] != NONE) continue;
+        order[root_id] = lowlink[root_id] = visited_cnt++;
+        call_stack.push_back(root_id);
+        component_stack.push_back(root_id);
+        while (!call_stack.empty()) {
+            size_t topic_id = call_stack.back();
+            const auto& required = data.dependencies[topic_id];
+            if (next_dependency[topic_id] < required.size()) {
+                size_t required_topic_id = required[next_dependency[topic_id]++];
+                if (order[required_topic_id] == NONE) {
+                    order[required_topic_id] = lowlink[required_topic_id] = visited_cnt++;
+                    call_stack.push_back(required_topic_id);
+                    component_stack.push_back(required_topic_id);
+                } else if (component[required_topic_id] == NONE) {
+                    // still on the component stack
+                    lowlink[topic_id] = std::min(lowlink[topic_id], order[required_topic_id]);
+                }
+                continue;
+            }
+            call_stack.pop_back();
+            if (!call_stack.empty()) {
+                lowlink[call_stack.back()] = std::min(lowlink[call_stack.back()], lowlink[topic_id]);
+            }
+            if (lowlink[topic_id] == order[topic_id]) {
+                size_t member_id;
+                do {
+                    member_id = component_stack.back();
+                    component_stack.pop_back();
+                    component[member_id] = component_cnt;
+                } while (member_id != topic_id);
+                ++component_cnt;
+            }
+        }
+    }
+
+    Data contracted;
+    contracted.topic_cnt = component_cnt;
+    contracted.values.assign(component_cnt, 0);
+    contracted.dependencies.resize(component_cnt);
+    for (size_t topic_id = 0; topic_id < data.topic_cnt; ++topic_id) {
+        contracted.values[component[topic_id]] += data.values[topic_id];
+        for (size_t required_topic_id : data.dependencies[topic_id]) {
+            if (component[required_topic_id] != component[topic_id]) {
+                contracted.dependencies[component[topic_id]].push_back(component[required_topic_id]);
+            }
+        }
+    }
+    for (auto& required : contracted.dependencies) {
+        std::sort(required.begin(), required.end());
+        required.erase(std::unique(required.begin(), required.end()), required.end());
+    }
+    return contracted;
+}
+
+// the project selection network: a topic ends up on the source side of the minimum cut iff it is chosen
+template<class Capacity>
+ResidualNetwork<Capacity> build_network(const Data& data) {
+    size_t source_id = data.topic_cnt,
+            sink_id   = data.topic_cnt + 1;
+    ResidualNetwork<Capacity> network(data.topic_cnt + 2, source_id, sink_id);
+    size_t edges_cnt = data.topic_cnt;
+    for (const auto& required : data.dependencies) {
+        edges_cnt += required.size();
+    }
+    network.reserve(edges_cnt);
+    // a cut through a dependency would cost more than cutting off every source edge, so it never happens
+    auto infinity = static_cast<Capacity>(data.positive_sum() + 1);
+    // data comes from contract_cycles: it has no cycles, self-loops or topics requiring each other
+    for (size_t topic_id = 0; topic_id < data.topic_cnt; ++topic_id) {
+        for (size_t required_topic_id : data.dependencies[topic_id]) {
+            assert(required_topic_id < topic_id);
+            network.add_edge(topic_id, required_topic_id, infinity);
+        }
+    }
+    for (size_t topic_id = 0; topic_id < data.topic_cnt; ++topic_id) {
+        if (data.values[topic_id] >= 0) {
+            network.add_edge(source_id, topic_id, static_cast<Capacity>(data.values[topic_id]));
+        } else {
+            network.add_edge(topic_id, sink_id, static_cast<Capacity>(-data.values[topic_id]));
+        }
+    }
+    return network;
+}
+
+template<template<class> class MaxFlowAlgorithm, class Capacity>
+long long solve(const Data& data) {
+    std::vector<size_t> component;
+    Data contracted = contract_cycles(data, component);
+    ResidualNetwork<Capacity> network = build_network<Capacity>(contracted);
+    MaxFlowAlgorithm<Capacity> algorithm;
+    algorithm.init(&network);
+    algorithm.run();
+    return contracted.positive_sum() - CapacityTraits<Capacity>::round(algorithm.flow());
+}
+
+// also stores the topics (numbered from 0) of an optimal choice in chosen
+template<template<class> class MaxFlowAlgorithm, class Capacity>
+long long solve(const Data& data, std::vector<size_t>& chosen) {
+    std::vector<size_t> component;
+    Data contracted = contract_cycles(data, component);
+    ResidualNetwork<Capacity> network = build_network<Capacity>(contracted);
+    MaxFlowAlgorithm<Capacity> algorithm;
+    algorithm.init(&network);
+    algorithm.run();
+    std::vector<bool> source_side = algorithm.min_cut();
+    chosen.clear();
+    for (size_t topic_id = 0; topic_id < data.topic_cnt; ++topic_id) {
+        if (source_side[component[topic_id]]) chosen.push_back(topic_id);
+    }
+    return contracted.positive_sum() - CapacityTraits<Capacity>::round(algorithm.flow());
+}
+
+template<class Capacity>
+long long solve_all(const Data& data) {
+    long long answer_malhotra     = solve<Malhotra, Capacity>(data);
+    long long answer_pushrelabel  = solve<PushRelabel, Capacity>(data);
+    long long answer_highestlabel = solve<HighestLabelPushRelabel, Capacity>(data);
+    long long answer_parallel     = solve<ParallelPushRelabel, Capacity>(data);
+    long long answer_dinic        = solve<Dinic, Capacity>(data);
+    long long answer_scalingdinic = solve<ScalingDinic, Capacity>(data);
+    long long answer_boykov       = solve<BoykovKolmogorov, Capacity>(data);
+    assert(answer_malhotra == answer_pushrelabel);
+    assert(answer_malhotra == answer_highestlabel);
+    assert(answer_malhotra == answer_parallel);
+    assert(answer_malhotra == answer_dinic);
+    assert(answer_malhotra == answer_scalingdinic);
+    assert(answer_malhotra == answer_boykov);
+    return answer_malhotra;
+}
+
+void run(std::istream& in, std::ostream& out) {
+    Data data;
+    data.read(in);
+    // 32-bit capacities halve the memory traffic; they do while INF plus any flow still fits
+    if (data.capacity_sum() < CapacityTraits<int>::INF) {
+        out << solve_all<int>(data);
+    } else {
+        out << solve_all<long long>(data);
+    }
+}
+
+namespace benchmark_utility {
+
+// DIMACS max-flow format: "p max <vertices> <arcs>", then "n <id> s" and "n <id> t", then one
+// "a <from> <to> <capacity>" per arc; vertices are numbered from 1 and "c" lines are comments.
+// The input is read at once and scanned by hand. Returns false if it is malformed.
+template<class Capacity>
+bool read_dimacs(std::istream& in, ResidualNetwork<Capacity>& network) {
+    std::string text;
+    std::vector<char> chunk(1 << 16);
+    while (in.read(chunk.data(), chunk.size()) || in.gcount() > 0) {
+        text.append(chunk.data(), in.gcount());
+    }
+    const char* position = text.data();
+    const char* end = position + text.size();
+
+    auto skip_blanks = [&]() {
+        while (position < end && (*position == ' ' || *position == '\t' || *position == '\r')) ++position;
+    };
+    auto read_number = [&](unsigned long long& value) {
+        skip_blanks();
+        if (position == end || *position < '0' || *position > '9') return false;
+        for (value = 0; position < end && *position >= '0' && *position <= '9'; ++position) {
+            value = value * 10 + static_cast<unsigned long long>(*position - '0');
+        }
+        return true;
+    };
+
+    unsigned long long vertices_cnt = 0,
+                       arcs_cnt = 0;
+    size_t source = ResidualNetwork<Capacity>::NONE,
+           sink = ResidualNetwork<Capacity>::NONE;
+    bool made = false;
+    auto make = [&]() {
+        if (made) return true;
+        if (source == ResidualNetwork<Capacity>::NONE || sink == ResidualNetwork<Capacity>::NONE) return false;
+        if (source == sink) return false;
+        network = ResidualNetwork<Capacity>(vertices_cnt, source, sink);
+        network.reserve(arcs_cnt);
+        return made = true;
+    };
+
+    while (position < end) {
+        skip_blanks();
+        if (position == end) break;
+        char kind = *position++;
+        if (kind == '\n') continue;
+        if (kind == 'p') {
+            skip_blanks();
+            if (end - position < 3 || std::string(position, 3) != "max") return false;
+            position += 3;
+            if (!read_number(vertices_cnt) || !read_number(arcs_cnt)) return false;
+        } else if (kind == 'n') {
+            unsigned long long id;
+            if (!read_number(id) || id == 0 || id > vertices_cnt) return false;
+            skip_blanks();
+            if (position == end || (*position != 's' && *position != 't')) return false;
+            (*position == 's' ? source : sink) = id - 1;
+        } else if (kind == 'a') {
+            unsigned long long from, to, capacity;
+            if (!make() || !read_number(from) || !read_number(to) || !read_number(capacity)) return false;
+            if (from == 0 || from > vertices_cnt || to == 0 || to > vertices_cnt) return false;
+            network.add_edge(from - 1, to - 1, static_cast<Capacity>(capacity));
+        } else if (kind != 'c') {
+            return false;
+        }
+        while (position < end && *position != '\n') ++position;
+        if (position < end) ++position;
+    }
+    return make();
+}
+
+// Modelled on the AK family of Cherkassky and Goldberg, which keeps push-relabel busy: a path
+// s -> a_1 -> ... -> a_k whose capacities shrink by one per step while every a_i leaks a unit to
+// the sink, and next to it a plain path s -> c_1 -> ... -> c_k -> t of capacity k.
+template<class Capacity>
+ResidualNetwork<Capacity> ak(size_t k) {
+    size_t source = 2 * k,
+           sink = 2 * k + 1;
+    ResidualNetwork<Capacity> network(2 * k + 2, source, sink);
+    network.reserve(4 * k + 1);
+    network.add_edge(source, 0, static_cast<Capacity>(k));
+    network.add_edge(source, k, static_cast<Capacity>(k));
+    for (size_t i = 0; i < k; ++i) {
+        if (i + 1 < k) {
+            network.add_edge(i, i + 1, static_cast<Capacity>(k - i - 1));
+            network.add_edge(k + i, k + i + 1, static_cast<Capacity>(k));
+        }
+        network.add_edge(i, sink, 1);
+    }
+    network.add_edge(2 * k - 1, sink, static_cast<Capacity>(k));
+    return network;
+}
+
+// Washington RLG (random level graph): levels of width vertices; every vertex has arcs to three
+// random vertices of the next level with capacities uniform in [1, max_capacity], the source
+// feeds every vertex of the first level and the last level drains into the sink.
+template<class Capacity>
+ResidualNetwork<Capacity> rlg(size_t width, size_t levels, unsigned long long max_capacity, std::mt19937_64& random) {
+    size_t source = width * levels,
+           sink = width * levels + 1;
+    ResidualNetwork<Capacity> network(width * levels + 2, source, sink);
+    network.reserve(2 * width + 3 * width * levels);
+    auto big = static_cast<Capacity>(3 * max_capacity);
+    for (size_t i = 0; i < width; ++i) {
+        network.add_edge(source, i, big);
+        network.add_edge((levels - 1) * width + i, sink, big);
+    }
+    for (size_t level = 0; level + 1 < levels; ++level) {
+        for (size_t i = 0; i < width; ++i) {
+            for (int arc = 0; arc < 3; ++arc) {
+                network.add_edge(level * width + i, (level + 1) * width + random() % width,
+                                 static_cast<Capacity>(1 + random() % max_capacity));
+            }
+        }
+    }
+    return network;
+}
+
+// genrmf (Goldfarb and Grigoriadis): frames side x side grids; inside a frame every vertex has
+// arcs to its neighbours with capacity c2 * side * side, and every vertex has an arc to the
+// vertex of the next frame given by a random permutation, with capacity uniform in [c1, c2].
+// The source is the first vertex of the first frame, the sink the last vertex of the last one.
+template<class Capacity>
+ResidualNetwork<Capacity> genrmf(size_t side, size_t frames, unsigned long long c1, unsigned long long c2,
+                                 std::mt19937_64& random) {
+    size_t frame_size = side * side;
+    ResidualNetwork<Capacity> network(frame_size * frames, 0, frame_size * frames - 1);
+    network.reserve(5 * frame_size * frames);
+    auto inside = static_cast<Capacity>(c2 * frame_size);
+    std::vector<size_t> permutation(frame_size);
+    for (size_t frame = 0; frame < frames; ++frame) {
+        size_t first = frame * frame_size;
+        for (size_t row = 0; row < side; ++row) {
+            for (size_t column = 0; column < side; ++column) {
+                size_t vertex_id = first + row * side + column;
+                if (column + 1 < side) network.add_edge(vertex_id, vertex_id + 1, inside, false);
+                if (row + 1 < side) network.add_edge(vertex_id, vertex_id + side, inside, false);
+            }
+        }
+        if (frame + 1 == frames) break;
+        for (size_t i = 0; i < frame_size; ++i) {
+            permutation[i] = i;
+        }
+        std::shuffle(permutation.begin(), permutation.end(), random);
+        for (size_t i = 0; i < frame_size; ++i) {
+            network.add_edge(first + i, first + frame_size + permutation[i],
+                             static_cast<Capacity>(c1 + random() % (c2 - c1 + 1)));
+        }
+    }
+    return network;
+}
+
+// A segmentation-style grid: a smooth image of side x side pixels with gaussian noise, its
+// intensities centred on zero as the terminal capacities, and neighbour capacities that fall off
+// with the difference of the intensities (and with distance for the diagonals), as for a graph cut
+// with a contrast-sensitive smoothness term.
+template<class Capacity>
+ResidualNetwork<Capacity> grid(size_t side, bool eight_connected, double noise, std::mt19937_64& random) {
+    std::vector<double> intensity(side * side);
+    std::normal_distribution<double> gaussian(0, noise);
+    for (size_t pixel = 0; pixel < side * side; ++pixel) {
+        double row = static_cast<double>(pixel / side),
+               column = static_cast<double>(pixel % side);
+        intensity[pixel] = 100 * std::sin(row / 37) * std::cos(column / 53) + gaussian(random);
+    }
+    return ResidualNetwork<Capacity>::grid(
+            side, side, eight_connected,
+            [&](size_t from, size_t to) {
+                double difference = intensity[from] - intensity[to],
+                       weight = 60 * std::exp(-difference * difference / (2 * noise * noise));
+                bool diagonal = (from / side != to / side && from % side != to % side);
+                return static_cast<Capacity>(1 + (diagonal ? weight / std::sqrt(2.0) : weight));
+            },
+            [&](size_t pixel) { return static_cast<Capacity>(intensity[pixel]); });
+}
+
+// A transportation problem: the source supplies each of suppliers vertices with up to [1, 1000]
+// units, each of consumers vertices takes up to [1, 1000] units to the sink, and every supplier
+// ships over arcs to degree random consumers, with no bound beyond its supply and a cost uniform
+// in [1, max_cost] per unit.
+template<class Capacity, class Cost>
+ResidualNetwork<Capacity, Cost> transportation(size_t suppliers, size_t consumers, size_t degree,
+                                               unsigned long long max_cost, std::mt19937_64& random) {
+    size_t source = suppliers + consumers,
+           sink = suppliers + consumers + 1;
+    ResidualNetwork<Capacity, Cost> network(suppliers + consumers + 2, source, sink);
+    network.reserve(suppliers * (degree + 1) + consumers);
+    for (size_t supplier = 0; supplier < suppliers; ++supplier) {
+        auto supply = static_cast<Capacity>(1 + random() % 1000);
+        network.add_edge(source, supplier, supply, 0);
+        for (size_t arc = 0; arc < degree; ++arc) {
+            network.add_edge(supplier, suppliers + random() % consumers, supply,
+                             static_cast<Cost>(1 + random() % max_cost));
+        }
+    }
+    for (size_t consumer = 0; consumer < consumers; ++consumer) {
+        network.add_edge(suppliers + consumer, sink, static_cast<Capacity>(1 + random() % 1000), 0);
+    }
+    return network;
+}
+
+// runs one algorithm on the network and prints its row of the comparison table
+template<template<class> class MaxFlowAlgorithm, class Capacity>
+void measure(const std::string& name, ResidualNetwork<Capacity>& network, const std::string& skip,
+             Capacity& reference, bool& has_reference, std::ostream& out) {
+    if (("," + skip + ",").find("," + name + ",") != std::string::npos) return;
+    MaxFlowAlgorithm<Capacity> algorithm;
+    algorithm.init(&network);
+    auto start = std::chrono::steady_clock::now();
+    algorithm.run();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    const auto& statistics = algorithm.statistics();
+    out << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(1)
+        << std::setw(12) << elapsed.count() << std::setw(16) << algorithm.flow()
+        << std::setw(12) << statistics.pushes << std::setw(12) << statistics.relabels
+        << std::setw(9) << statistics.phases << std::setw(13) << algorithm.memory() / 1024;
+    if (has_reference && algorithm.flow() != reference) out << "  DIFFERS";
+    out << std::endl;
+    reference = algorithm.flow();
+    has_reference = true;
+}
+
+template<class Capacity>
+void compare(ResidualNetwork<Capacity>& network, const std::string& description, const std::string& skip,
+             std::ostream& out) {
+    network.discard_flow();
+    out << description << ": " << network.vertices_cnt() << " vertices, " << network.edges_cnt()
+        << " residual edges, network " << network.memory() / 1024 << " KiB\n";
+    out << std::left << std::setw(14) << "algorithm" << std::right << std::setw(12) << "time, ms"
+        << std::setw(16) << "flow" << std::setw(12) << "pushes" << std::setw(12) << "relabels"
+        << std::setw(9) << "phases" << std::setw(13) << "memory, KiB" << std::endl;
+    Capacity reference = 0;
+    bool has_reference = false;
+    measure<Malhotra>("Malhotra", network, skip, reference, has_reference, out);
+    measure<PushRelabel>("PushRelabel", network, skip, reference, has_reference, out);
+    measure<HighestLabelPushRelabel>("HighestLabel", network, skip, reference, has_reference, out);
+    measure<ParallelPushRelabel>("Parallel", network, skip, reference, has_reference, out);
+    measure<Dinic>("Dinic", network, skip, reference, has_reference, out);
+    measure<ScalingDinic>("ScalingDinic", network, skip, reference, has_reference, out);
+    measure<BoykovKolmogorov>("Boykov", network, skip, reference, has_reference, out);
+}
+
+// the same for the min-cost flow algorithms, with the cost of the flow after its value
+template<template<class, class> class MinCostFlowAlgorithm, class Capacity, class Cost>
+void measure_cost(const std::string& name, ResidualNetwork<Capacity, Cost>& network, const std::string& skip,
+                  Cost& reference, bool& has_reference, std::ostream& out) {
+    if (("," + skip + ",").find("," + name + ",") != std::string::npos) return;
+    MinCostFlowAlgorithm<Capacity, Cost> algorithm;
+    algorithm.init(&network);
+    auto start = std::chrono::steady_clock::now();
+    algorithm.run();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    const auto& statistics = algorithm.statistics();
+    out << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(1)
+        << std::setw(12) << elapsed.count() << std::setw(12) << algorithm.flow() << std::setw(16) << algorithm.cost()
+        << std::setw(12) << statistics.pushes << std::setw(12) << statistics.relabels
+        << std::setw(9) << statistics.phases << std::setw(13) << algorithm.memory() / 1024;
+    if (has_reference && algorithm.cost() != reference) out << "  DIFFERS";
+    out << std::endl;
+    reference = algorithm.cost();
+    has_reference = true;
+}
+
+template<class Capacity, class Cost>
+void compare_costs(ResidualNetwork<Capacity, Cost>& network, const std::string& description, const std::string& skip,
+                   std::ostream& out) {
+    network.discard_flow();
+    out << description << ": " << network.vertices_cnt() << " vertices, " << network.edges_cnt()
+        << " residual edges, network " << network.memory() / 1024 << " KiB\n";
+    out << std::left << std::setw(14) << "algorithm" << std::right << std::setw(12) << "time, ms"
+        << std::setw(12) << "flow" << std::setw(16) << "cost" << std::setw(12) << "pushes"
+        << std::setw(12) << "relabels" << std::setw(9) << "phases" << std::setw(13) << "memory, KiB" << std::endl;
+    Cost reference = 0;
+    bool has_reference = false;
+    measure_cost<SuccessiveShortestPaths>("ShortestPaths", network, skip, reference, has_reference, out);
+    measure_cost<CostScaling>("CostScaling", network, skip, reference, has_reference, out);
+}
+
+// arguments after --benchmark; returns the exit code
+int benchmark(const std::vector<std::string>& arguments) {
+    auto invalid = [](const char* message) {
+        std::cerr << message << "\n";
+        return 1;
+    };
+    // the whole argument as a decimal number; from_chars takes no sign for an unsigned value
+    auto parse = [](const std::string& text, unsigned long long& value) {
+        auto parsed = std::from_chars(text.data(), text.data() + text.size(), value);
+        return !text.empty() && parsed.ec == std::errc() && parsed.ptr == text.data() + text.size();
+    };
+    std::vector<std::string> positional;
+    std::string skip;
+    unsigned long long seed = 1;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        if (arguments[i] == "--skip" && i + 1 < arguments.size()) {
+            skip = arguments[++i];
+        } else if (arguments[i] == "--seed" && i + 1 < arguments.size()) {
+            if (!parse(arguments[++i], seed)) return invalid("--seed needs a non-negative integer");
+        } else {
+            positional.push_back(arguments[i]);
+        }
+    }
+    std::vector<unsigned long long> numbers(positional.size());
+    for (size_t index = 1; index < positional.size(); ++index) {
+        if (!parse(positional[index], numbers[index])) {
+            return invalid("the network parameters must be non-negative integers");
+        }
+    }
+    auto number = [&](size_t index, unsigned long long otherwise) {
+        return index < numbers.size() ? numbers[index] : otherwise;
+    };
+    // vertex counts are computed in size_t; far below where that wraps, the network would not fit anyway
+    auto too_large = [](double vertices_cnt) { return vertices_cnt > 1e12; };
+    std::mt19937_64 random(seed);
+    std::string family = (positional.empty() ? "" : positional[0]);
+    if (family == "transportation") {
+        if (number(2, 100) == 0 || number(4, 1000) == 0) {
+            return invalid("transportation needs consumers and max cost >= 1");
+        }
+        if (too_large(static_cast<double>(number(1, 100)) * (static_cast<double>(number(3, 10)) + 1)
+                      + static_cast<double>(number(2, 100)))) {
+            return invalid("transportation network too large");
+        }
+        auto network = transportation<long long, long long>(number(1, 100), number(2, 100), number(3, 10),
+                                                            number(4, 1000), random);
+        std::ostringstream description;
+        description << "transportation " << number(1, 100) << " x " << number(2, 100) << " degree=" << number(3, 10);
+        compare_costs(network, description.str(), skip, std::cout);
+        return 0;
+    }
+    ResidualNetwork<long long> network;
+    std::ostringstream description;
+    if (family == "dimacs") {
+        if (!read_dimacs(std::cin, network)) {
+            std::cerr << "malformed DIMACS input\n";
+            return 1;
+        }
+        description << "dimacs";
+    } else if (family == "ak") {
+        if (number(1, 1000) == 0) return invalid("ak needs k >= 1");
+        if (too_large(2.0 * static_cast<double>(number(1, 1000)))) return invalid("ak network too large");
+        network = ak<long long>(number(1, 1000));
+        description << "ak k=" << number(1, 1000);
+    } else if (family == "rlg") {
+        if (number(1, 64) == 0 || number(2, 64) == 0 || number(3, 10000) == 0) {
+            return invalid("rlg needs width, levels and max capacity >= 1");
+        }
+        if (too_large(static_cast<double>(number(1, 64)) * static_cast<double>(number(2, 64)))) {
+            return invalid("rlg network too large");
+        }
+        network = rlg<long long>(number(1, 64), number(2, 64), number(3, 10000), random);
+        description << "rlg width=" << number(1, 64) << " levels=" << number(2, 64);
+    } else if (family == "genrmf") {
+        // the source and the sink are the first and the last vertex, and c2 - c1 + 1 is a modulus
+        double vertices_cnt = static_cast<double>(number(1, 16)) * static_cast<double>(number(1, 16))
+                              * static_cast<double>(number(2, 16));
+        if (number(1, 16) == 0 || number(2, 16) == 0 || vertices_cnt < 2) {
+            return invalid("genrmf needs side and frames >= 1 and at least two vertices");
+        }
+        if (too_large(vertices_cnt)) return invalid("genrmf network too large");
+        if (number(3, 1) > number(4, 10000) || number(4, 10000) == std::numeric_limits<unsigned long long>::max()) {
+            return invalid("genrmf needs c1 <= c2 < 2^64 - 1");
+        }
+        network = genrmf<long long>(number(1, 16), number(2, 16), number(3, 1), number(4, 10000), random);
+        description << "genrmf side=" << number(1, 16) << " frames=" << number(2, 16);
+    } else if (family == "grid") {
+        if (number(1, 512) == 0 || (number(2, 4) != 4 && number(2, 4) != 8) || number(3, 20) == 0) {
+            return invalid("grid needs side >= 1, connectivity 4 or 8 and noise >= 1");
+        }
+        if (too_large(static_cast<double>(number(1, 512)) * static_cast<double>(number(1, 512)))) {
+            return invalid("grid network too large");
+        }
+        auto start = std::chrono::steady_clock::now();
+        network = grid<long long>(number(1, 512), number(2, 4) == 8, static_cast<double>(number(3, 20)), random);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        description << "grid side=" << number(1, 512) << " connectivity=" << number(2, 4) << " built in "
+                    << std::fixed << std::setprecision(1) << elapsed.count() << " ms";
+    } else {
+        std::cerr << "unknown network family '" << family << "'\n";
+        return 1;
+    }
+    compare(network, description.str(), skip, std::cout);
+    return 0;
+}
+
+}  // namespace benchmark_utility
+
+// no arguments: solve the project selection problem from stdin;
+// --benchmark dimacs | ak [<k>] | rlg [<width> <levels> <max capacity>] | genrmf [<side> <frames> <c1> <c2>]
+//             | grid [<side> <4 or 8> <noise>]
+//             | transportation [<suppliers> <consumers> <degree> <max cost>]
+// [--seed <n>] [--skip <algorithm>,...]: time every max-flow algorithm (min-cost flow algorithm for
+// transportation) on one network, read from stdin for dimacs or generated otherwise, and print a
+// comparison table
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--benchmark") {
+        return benchmark_utility::benchmark(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    run(std::cin, std::cout);
+}
@@ -3,40 +3,108 @@
 #include <cstdio>
 #include <algorithm>
 #include <limits>
-#include <random>
 #include <ctime>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <charconv>
+
+// Priorities of new treap nodes. The default generator is splitmix64 over a counter, seeded
+// with the current time; seed() makes runs reproducible, set() plugs in another generator.
+class PrioritySource
+{
+private:
+    static unsigned long long state_;
+    static size_t (*generator_)();
+
+public:
+    typedef size_t (*Generator)();
+
+    static size_t splitmix();
+    static void seed(unsigned long long);
+    static void set(Generator);
+    static size_t next();
+};
+
+unsigned long long PrioritySource::state_ = static_cast<unsigned long long>(time(0));
+PrioritySource::Generator PrioritySource::generator_ = PrioritySource::splitmix;
+
+size_t PrioritySource::splitmix()
+{
+    unsigned long long z = (state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<size_t>(z ^ (z >> 31));
+}
+
+void PrioritySource::seed(unsigned long long seed)
+{ state_ = seed; }
+
+void PrioritySource::set(Generator generator)
+{ generator_ = generator; }
+
+size_t PrioritySource::next()
+{ return generator_(); }
 
 class Treap
 {
+public:
+
+    // counters of the calling thread since the last reset_statistics(); read-only queries do not touch them
+    struct Statistics
+    {
+        size_t operations, splits, merges, pushes;
+    };
+
+    // a value to insert before the element at the given position
+    typedef std::pair<size_t, long long> Insertion;
+
 private:
 
     static const long long INF_VALUE = static_cast<long long>(1e14);
     static const size_t INF_INDEX = static_cast<size_t>(1e9);
+    static const size_t INF_COUNT = static_cast<size_t>(1) << 62;
+    static const size_t PARALLEL_GRAIN = static_cast<size_t>(1) << 14;
+    static const char CHECKPOINT_MAGIC[8];
 
-    static size_t get_random()
-    {
-        static std::mt19937 random_generator(time(0));
-        static std::uniform_int_distribution<size_t> distribute(0, INF_INDEX);
-        return distribute(random_generator);
-    }
+    static thread_local Statistics statistics_;
 
     struct Node
     {
         long long value, bound[2], border[2], paint, add, sum;
-        size_t priority, size;
+        size_t priority, size, references;
         bool reversed, inversion[2];
         Node *child[2];
 
         explicit Node(long long);
+        Node(long long, size_t);
     };
     typedef Node *Link;
 
+    // lazy tags pending above a node, applied on the fly by the read-only descent
+    struct Tag
+    {
+        bool reversed;
+        long long paint, add;
+
+        Tag();
+        long long value(Link) const;
+        long long sum(Link) const;
+        long long bound(Link, size_t) const;
+        Tag down(Link) const;
+    };
+
     Link root_;
 
     static bool compare(const long long&, const long long&, size_t);
     static long long min_max(const long long&, const long long&, size_t);
     static void create(Link&, const long long&);
     static void remove(Link&);
+    static Link share_(Link);
+    static void detach_(Link&);
     static size_t subtree_size_(Link);
     static long long subtree_sum_(Link);
     static long long subtree_bound_(Link, size_t);
@@ -67,10 +135,25 @@ private:
         Link &get();
     };
 
-    static void print_(Link, std::ostream&);
-    static size_t get_inversion_(Link, size_t, size_t);
-    static size_t get_nearest_(Link, const long long&, size_t, size_t);
-    void destruct(Link);
+    template<typename Output>
+    static void print_(Link&, Output&);
+    static void write_(Link, const Tag&, long long*, size_t);
+    static size_t get_inversion_(Link&, size_t, size_t);
+    static size_t get_nearest_(Link&, const long long&, size_t, size_t);
+    static long long prefix_sum_(Link, size_t);
+    static long long range_bound_(Link, const Tag&, size_t, size_t, size_t);
+    static size_t lower_bound_(Link, const Tag&, size_t, size_t, const long long&);
+    static size_t count_less_(Link, const Tag&, size_t, size_t, const long long&);
+    static void destruct(Link, size_t = 1);
+    void measure_(size_t&, size_t&, size_t&) const;
+    template<typename Left, typename Right>
+    static void fork_join_(size_t, size_t, Left, Right);
+    static void sift_down_(Link);
+    static Link build_(const long long*, const size_t*, size_t, size_t);
+    static Link build_(const std::vector<long long>&, size_t = 1);
+    static Link insert_(Link, const Insertion*, const size_t*, size_t, size_t, size_t);
+    static size_t multinomial_(const std::vector<size_t>&);
+    static bool advance_(std::vector<long long>&, size_t, size_t&, bool);
 
     template<typename ReturnType, typename Operation>
     ReturnType perform_operation(size_t, size_t, Operation operate);
@@ -85,35 +168,96 @@ public:
         PAINT = 4,
         ADD = 5,
         NEXT_PERMUTATION = 6,
-        PREV_PERMUTATION = 7
+        PREV_PERMUTATION = 7,
+        MIN = 8,
+        MAX = 9,
+        LOWER_BOUND = 10,
+        COUNT_LESS = 11,
+        KTH = 12
     };
 
     Treap();
+    explicit Treap(const std::vector<long long>&, size_t = 1);
+    Treap(const Treap&);
+    Treap(Treap&&);
+    Treap &operator=(Treap);
     ~Treap();
+    Treap snapshot() const;
     void insert(const long long&, size_t);
+    void insert(const std::vector<Insertion>&, size_t = 1);
     void remove(size_t);
     void paint(const long long&, size_t, size_t);
     void add(const long long&, size_t, size_t);
-    long long get_sum(size_t, size_t);
+    long long get_sum(size_t, size_t) const;
+    long long get_min(size_t, size_t) const;
+    long long get_max(size_t, size_t) const;
+    size_t lower_bound(const long long&, size_t, size_t) const;
+    size_t count_less(const long long&, size_t, size_t) const;
+    long long get_kth(size_t, size_t, size_t) const;
     void permute(size_t, size_t, QueryType);
+    void permute(size_t, size_t, QueryType, size_t);
     static void permute(Link & t, QueryType);
-    void print(std::ostream&);
+    static void permute(Link & t, QueryType, size_t);
+    size_t size() const;
+    std::vector<long long> values(size_t = 1) const;
+    void clear(size_t = 1);
+    bool save(const std::string&, size_t = 1) const;
+    bool load(const std::string&, size_t = 1);
+    template<typename Output>
+    void print(Output&);
+
+    size_t height() const;
+    double average_depth() const;
+    static const Statistics &statistics();
+    static void reset_statistics();
+
+    friend class ConcurrentTreap;
 };
 
 Treap::Node::Node(long long _value)
+        : Node(_value, PrioritySource::next())
+{}
+
+Treap::Node::Node(long long _value, size_t _priority)
         : value(_value)
         , bound({_value, _value})
         , border({_value, _value})
         , paint(INF_VALUE)
         , add(0)
         , sum(_value)
-        , priority(get_random())
+        , priority(_priority)
         , size(1)
+        , references(1)
         , reversed(false)
         , inversion({false, false})
         , child({nullptr, nullptr})
 {}
 
+Treap::Tag::Tag()
+        : reversed(false)
+        , paint(INF_VALUE)
+        , add(0)
+{}
+
+long long Treap::Tag::value(Link t) const
+{ return (paint != INF_VALUE ? paint : t->value) + add; }
+
+long long Treap::Tag::sum(Link t) const
+{ return (paint != INF_VALUE ? (long long)(t->size) * paint : t->sum) + (long long)(t->size) * add; }
+
+long long Treap::Tag::bound(Link t, size_t type) const
+{ return (paint != INF_VALUE ? paint : t->bound[type]) + add; }
+
+// the tag t's children would get if this one were pushed into t and then t were pushed
+Treap::Tag Treap::Tag::down(Link t) const
+{
+    Tag answer;
+    answer.reversed = reversed ^ t->reversed;
+    answer.paint = (paint != INF_VALUE ? paint : t->paint);
+    answer.add = (paint != INF_VALUE ? add : t->add + add);
+    return answer;
+}
+
 bool Treap::compare(const long long &a, const long long &b, size_t type)
 {
     if (type) return a > b;
@@ -133,10 +277,27 @@ void Treap::create(Link & t, const long long &value)
 
 void Treap::remove(Link & t)
 {
-    delete t;
+    destruct(t);
     t = nullptr;
 }
 
+Treap::Link Treap::share_(Link t)
+{
+    if (t != nullptr) ++t->references;
+    return t;
+}
+
+// a node shared with another version is copied before being written to
+void Treap::detach_(Link &t)
+{
+    if (t == nullptr || t->references == 1) return;
+    --t->references;
+    t = new Node(*t);
+    t->references = 1;
+    for (Link son : t->child)
+        share_(son);
+}
+
 size_t Treap::subtree_size_(Link t)
 {
     return t != nullptr ? t->size : 0;
@@ -269,6 +430,12 @@ void Treap::push_add_(Link t)
 void Treap::push_(Link t)
 {
     if (t == nullptr) return;
+    if (t->reversed || t->paint != INF_VALUE || t->add != 0)
+    {
+        ++statistics_.pushes;
+        for (Link &son : t->child)
+            detach_(son);
+    }
     push_reverse_(t);
     push_paint_(t);
     push_add_(t);
@@ -276,6 +443,8 @@ void Treap::push_(Link t)
 
 void Treap::split_(Link t, Link &left, Link &right, size_t key, size_t cur_key = 0)
 {
+    ++statistics_.splits;
+    detach_(t);
     push_(t);
     if (t == nullptr) left = right = nullptr;
     else if (key <= cur_key + subtree_size_(t->child[0]))
@@ -292,6 +461,9 @@ void Treap::split_(Link t, Link &left, Link &right, size_t key, size_t cur_key =
 
 void Treap::merge_(Link &t, Link left, Link right)
 {
+    ++statistics_.merges;
+    detach_(left);
+    detach_(right);
     push_(left);
     push_(right);
     if (left == nullptr || right == nullptr)
@@ -327,17 +499,33 @@ Treap::SegmentSplitter::~SegmentSplitter()
 Treap::Link &Treap::SegmentSplitter::get()
 { return mid; }
 
-void Treap::print_(Link t, std::ostream &out)
+template<typename Output>
+void Treap::print_(Link &t, Output &out)
 {
     if (t == nullptr) return;
+    detach_(t);
     push_(t);
     print_(t->child[0], out);
     out << t->value << " ";
     print_(t->child[1], out);
 }
 
-size_t Treap::get_inversion_(Link t, size_t type, size_t cur_key = 0)
+// writes the values of the subtree to out in order, applying the pending tags on the way down
+void Treap::write_(Link t, const Tag &pending, long long *out, size_t threads)
+{
+    if (t == nullptr) return;
+    Link son[2] = {t->child[pending.reversed], t->child[!pending.reversed]};
+    Tag tag = pending.down(t);
+    size_t key = subtree_size_(son[0]);
+    out[key] = pending.value(t);
+    fork_join_(threads, t->size,
+               [&]() { write_(son[0], tag, out, threads / 2); },
+               [&]() { write_(son[1], tag, out + key + 1, threads - threads / 2); });
+}
+
+size_t Treap::get_inversion_(Link &t, size_t type, size_t cur_key = 0)
 {
+    detach_(t);
     push_(t);
     if (t == nullptr || t->inversion[type] == false)
         return INF_INDEX;
@@ -350,8 +538,9 @@ size_t Treap::get_inversion_(Link t, size_t type, size_t cur_key = 0)
     return get_inversion_(t->child[0], type, cur_key);
 }
 
-size_t Treap::get_nearest_(Link t, const long long &val, size_t type, size_t cur_key = 0)
+size_t Treap::get_nearest_(Link &t, const long long &val, size_t type, size_t cur_key = 0)
 {
+    detach_(t);
     push_(t);
     if (t->child[1] != nullptr && compare(val, t->child[1]->bound[!type], type))
         return get_nearest_(t->child[1], val, type, cur_key + subtree_size_(t->child[0]) + 1);
@@ -360,37 +549,221 @@ size_t Treap::get_nearest_(Link t, const long long &val, size_t type, size_t cur
     return get_nearest_(t->child[0], val, type, cur_key);
 }
 
-void Treap::destruct(Link t)
+// sum of the first key elements: a single root-to-leaf walk that never writes to nodes
+long long Treap::prefix_sum_(Link t, size_t key)
 {
-    if (t == nullptr) return;
-    destruct(t->child[0]);
-    destruct(t->child[1]);
+    Tag pending;
+    long long answer = 0;
+    while (t != nullptr && key > 0)
+    {
+        if (key >= t->size)
+            return answer + pending.sum(t);
+        Link left = t->child[pending.reversed], right = t->child[!pending.reversed];
+        Tag tag = pending.down(t);
+        if (key <= subtree_size_(left))
+        {
+            t = left;
+        } else
+        {
+            answer += (left != nullptr ? tag.sum(left) : 0) + pending.value(t);
+            key -= subtree_size_(left) + 1;
+            t = right;
+        }
+        pending = tag;
+    }
+    return answer;
+}
+
+// the bounds below descend into the half-open segment [left, right) of the subtree
+long long Treap::range_bound_(Link t, const Tag &pending, size_t left, size_t right, size_t type)
+{
+    if (t == nullptr || left >= right) return subtree_bound_(nullptr, type);
+    if (left == 0 && right >= t->size) return pending.bound(t, type);
+    Link son[2] = {t->child[pending.reversed], t->child[!pending.reversed]};
+    Tag tag = pending.down(t);
+    size_t key = subtree_size_(son[0]);
+    long long answer = subtree_bound_(nullptr, type);
+    if (left < key)
+        answer = min_max(answer, range_bound_(son[0], tag, left, std::min(right, key), type), type);
+    if (left <= key && key < right)
+        answer = min_max(answer, pending.value(t), type);
+    if (right > key + 1)
+        answer = min_max(answer, range_bound_(son[1], tag, std::max(left, key + 1) - key - 1,
+                                              right - key - 1, type), type);
+    return answer;
+}
+
+size_t Treap::lower_bound_(Link t, const Tag &pending, size_t left, size_t right, const long long &x)
+{
+    if (t == nullptr || left >= right || pending.bound(t, 1) < x) return INF_INDEX;
+    Link son[2] = {t->child[pending.reversed], t->child[!pending.reversed]};
+    Tag tag = pending.down(t);
+    size_t key = subtree_size_(son[0]), found = INF_INDEX;
+    if (left < key)
+        found = lower_bound_(son[0], tag, left, std::min(right, key), x);
+    if (found == INF_INDEX && left <= key && key < right && pending.value(t) >= x)
+        found = key;
+    if (found == INF_INDEX && right > key + 1)
+    {
+        found = lower_bound_(son[1], tag, std::max(left, key + 1) - key - 1, right - key - 1, x);
+        if (found != INF_INDEX) found += key + 1;
+    }
+    return found;
+}
+
+// exact; subtrees lying entirely below or above x are counted without descending into them
+size_t Treap::count_less_(Link t, const Tag &pending, size_t left, size_t right, const long long &x)
+{
+    if (t == nullptr || left >= right) return 0;
+    if (left == 0 && right >= t->size)
+    {
+        if (pending.bound(t, 1) < x) return t->size;
+        if (pending.bound(t, 0) >= x) return 0;
+    }
+    Link son[2] = {t->child[pending.reversed], t->child[!pending.reversed]};
+    Tag tag = pending.down(t);
+    size_t key = subtree_size_(son[0]), answer = 0;
+    if (left < key)
+        answer += count_less_(son[0], tag, left, std::min(right, key), x);
+    if (left <= key && key < right && pending.value(t) < x)
+        ++answer;
+    if (right > key + 1)
+        answer += count_less_(son[1], tag, std::max(left, key + 1) - key - 1, right - key - 1, x);
+    return answer;
+}
+
+void Treap::destruct(Link t, size_t threads)
+{
+    if (t == nullptr || --t->references > 0) return;
+    fork_join_(threads, t->size,
+               [&]() { destruct(t->child[0], threads / 2); },
+               [&]() { destruct(t->child[1], threads - threads / 2); });
     delete t;
 }
 
+// Runs both parts, the left one on a new thread if the budget allows it and there is enough
+// work to pay for the thread; each part is expected to use half of the budget.
+template<typename Left, typename Right>
+void Treap::fork_join_(size_t threads, size_t work, Left left, Right right)
+{
+    if (threads < 2 || work < PARALLEL_GRAIN)
+    {
+        left();
+        right();
+        return;
+    }
+    std::thread worker(left);
+    right();
+    worker.join();
+}
+
+// height, number of nodes and sum of node depths, without recursion so that a degenerate tree is fine
+void Treap::measure_(size_t &height, size_t &nodes, size_t &depth_sum) const
+{
+    height = nodes = depth_sum = 0;
+    std::vector<std::pair<Link, size_t>> stack;
+    if (root_ != nullptr) stack.emplace_back(root_, 0);
+    while (!stack.empty())
+    {
+        Link t = stack.back().first;
+        size_t depth = stack.back().second;
+        stack.pop_back();
+        height = std::max(height, depth + 1);
+        ++nodes;
+        depth_sum += depth;
+        for (Link son : t->child)
+            if (son != nullptr) stack.emplace_back(son, depth + 1);
+    }
+}
+
 template<typename ReturnType, typename Operation>
 ReturnType Treap::perform_operation(size_t left, size_t right, Operation operate)
-{ return operate(SegmentSplitter(root_, left, right).get()); }
+{
+    ++statistics_.operations;
+    return operate(SegmentSplitter(root_, left, right).get());
+}
+
+thread_local Treap::Statistics Treap::statistics_ = {0, 0, 0, 0};
+const char Treap::CHECKPOINT_MAGIC[8] = {'T', 'R', 'E', 'A', 'P', 'v', '1', '\0'};
 
 Treap::Treap() : root_(nullptr) {}
+Treap::Treap(const std::vector<long long> &values, size_t threads) : root_(build_(values, threads)) {}
+Treap::Treap(const Treap &other) : root_(share_(other.root_)) {}
+Treap::Treap(Treap &&other) : root_(other.root_) { other.root_ = nullptr; }
 Treap::~Treap() { destruct(root_); }
 
+Treap &Treap::operator=(Treap other)
+{
+    std::swap(root_, other.root_);
+    return *this;
+}
+
+// versions share nodes and copy them on write, so old snapshots stay intact
+Treap Treap::snapshot() const
+{ return *this; }
+
 void Treap::insert(const long long &x, size_t pos)
 {
     perform_operation<void>(pos, pos - 1, [x](Link &t)
     { create(t, x); });
 }
 
+// Inserts each value before the element that is at its position now, so positions refer to
+// the treap as it was before the call; they must be non-decreasing, and values with equal
+// positions keep their order. Union-style: the middle insertion splits the tree and both
+// halves of the batch go into their parts independently.
+void Treap::insert(const std::vector<Insertion> &batch, size_t threads)
+{
+    std::vector<size_t> priority(batch.size());
+    for (size_t &p : priority)
+        p = PrioritySource::next();
+    ++statistics_.operations;
+    root_ = insert_(root_, batch.data(), priority.data(), batch.size(), 0, threads);
+}
+
 void Treap::remove(size_t pos)
 {
     perform_operation<void>(pos, pos, [](Link &t)
     { remove(t); });
 }
 
-long long Treap::get_sum(size_t left, size_t right)
+long long Treap::get_sum(size_t left, size_t right) const
+{ return prefix_sum_(root_, right + 1) - prefix_sum_(root_, left); }
+
+long long Treap::get_min(size_t left, size_t right) const
+{ return range_bound_(root_, Tag(), left, right + 1, 0); }
+
+long long Treap::get_max(size_t left, size_t right) const
+{ return range_bound_(root_, Tag(), left, right + 1, 1); }
+
+// the first position in [left, right] holding a value >= x, or right + 1 if there is none
+size_t Treap::lower_bound(const long long &x, size_t left, size_t right) const
 {
-    return perform_operation<long long>(left, right, [](Link t)
-    { return subtree_sum_(t); });
+    size_t found = lower_bound_(root_, Tag(), left, right + 1, x);
+    return found != INF_INDEX ? found : right + 1;
+}
+
+size_t Treap::count_less(const long long &x, size_t left, size_t right) const
+{ return count_less_(root_, Tag(), left, right + 1, x); }
+
+// the k-th smallest value in [left, right], counting from 0; k must be at most right - left.
+// The answer is the largest value v with fewer than k + 1 elements below it, found by a binary
+// search between the range bounds with one count_less descent per step. That is up to 64
+// descents, and each is linear on an unsorted range: the query is not O(log n).
+long long Treap::get_kth(size_t k, size_t left, size_t right) const
+{
+    long long low = get_min(left, right), high = get_max(left, right);
+    while (low < high)
+    {
+        // above low and at most high; the distance is unsigned, so a full 64-bit span does not wrap to 0
+        long long mid = static_cast<long long>(static_cast<unsigned long long>(low)
+                                               + (static_cast<unsigned long long>(high) - low) / 2 + 1);
+        if (count_less(mid, left, right) <= k)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    return low;
 }
 
 void Treap::paint(const long long &x, size_t left, size_t right)
@@ -405,7 +778,91 @@ void Treap::add(const long long &x, size_t left, size_t right)
     { subtree_add_(t, x); });
 }
 
-void Treap::print(std::ostream &out)
+size_t Treap::size() const
+{ return subtree_size_(root_); }
+
+size_t Treap::height() const
+{
+    size_t height, nodes, depth_sum;
+    measure_(height, nodes, depth_sum);
+    return height;
+}
+
+double Treap::average_depth() const
+{
+    size_t height, nodes, depth_sum;
+    measure_(height, nodes, depth_sum);
+    return nodes != 0 ? double(depth_sum) / nodes : 0;
+}
+
+const Treap::Statistics &Treap::statistics()
+{ return statistics_; }
+
+void Treap::reset_statistics()
+{ statistics_ = {0, 0, 0, 0}; }
+
+std::vector<long long> Treap::values(size_t threads) const
+{
+    std::vector<long long> answer(size());
+    write_(root_, Tag(), answer.data(), threads);
+    return answer;
+}
+
+void Treap::clear(size_t threads)
+{
+    destruct(root_, threads);
+    root_ = nullptr;
+}
+
+// The checkpoint is CHECKPOINT_MAGIC, the element count and the values in order, all of them
+// 64-bit in the byte order of the host with the tags already applied: past the 16-byte header
+// the file can be memory-mapped as an array of long long, but it is not portable between
+// little- and big-endian machines. Returns false if the file cannot be written.
+bool Treap::save(const std::string &path, size_t threads) const
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    std::vector<long long> buffer = values(threads);
+    unsigned long long count = buffer.size();
+    bool good = fwrite(CHECKPOINT_MAGIC, 1, sizeof(CHECKPOINT_MAGIC), file) == sizeof(CHECKPOINT_MAGIC)
+                && fwrite(&count, sizeof(count), 1, file) == 1
+                && fwrite(buffer.data(), sizeof(long long), count, file) == count;
+    return fclose(file) == 0 && good;
+}
+
+// rebuilds the treap from a checkpoint in linear time; on a missing or malformed file
+// returns false and keeps the current contents
+bool Treap::load(const std::string &path, size_t threads)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    unsigned long long count = 0;
+    const long header = sizeof(magic) + sizeof(count);
+    bool good = fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+                && memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0
+                && fread(&count, sizeof(count), 1, file) == 1
+                && fseek(file, 0, SEEK_END) == 0;
+    // the payload is compared by division, so that no count can overflow the expected size
+    long file_size = good ? ftell(file) : -1;
+    good = good && file_size >= header
+           && (file_size - header) % sizeof(long long) == 0
+           && count == (file_size - header) / sizeof(long long)
+           && fseek(file, header, SEEK_SET) == 0;
+    std::vector<long long> buffer;
+    if (good)
+    {
+        buffer.resize(count);
+        good = fread(buffer.data(), sizeof(long long), count, file) == count;
+    }
+    fclose(file);
+    if (!good) return false;
+    *this = Treap(buffer, threads);
+    return true;
+}
+
+template<typename Output>
+void Treap::print(Output &out)
 { print_(root_, out); out << "\n"; }
 
 void Treap::permute(Link & t, QueryType permutation_type)
@@ -434,179 +891,1504 @@ void Treap::permute(Link & t, QueryType permutation_type)
     merge_(t, t, suffix);
 }
 
-void Treap::permute(size_t left, size_t right, QueryType permutation_type)
+// moves the priority of t down until it is not below those of its children; the shape stays
+void Treap::sift_down_(Link t)
 {
-    perform_operation<void>(left, right, [permutation_type](Link & t)
-    { permute(t, permutation_type); });
+    while (true)
+    {
+        Link largest = t;
+        for (Link son : t->child)
+            if (son != nullptr && son->priority > largest->priority)
+                largest = son;
+        if (largest == t) return;
+        std::swap(t->priority, largest->priority);
+        t = largest;
+    }
 }
 
-namespace query_utility
+// A perfectly balanced tree over values[0..n) built bottom-up in linear time. The priorities
+// are heapified on the way back up, so the result is a valid treap for later splits and merges.
+Treap::Link Treap::build_(const long long *values, const size_t *priority, size_t n, size_t threads)
 {
-    struct Query
-    {
-        Treap::QueryType type;
-        virtual void make_virtual() const {}
-    };
+    if (n == 0) return nullptr;
+    size_t mid = n / 2;
+    Link t = new Node(values[mid], priority[mid]);
+    fork_join_(threads, n,
+               [&]() { t->child[0] = build_(values, priority, mid, threads / 2); },
+               [&]() { t->child[1] = build_(values + mid + 1, priority + mid + 1, n - mid - 1,
+                                            threads - threads / 2); });
+    sift_down_(t);
+    update_(t);
+    return t;
+}
+
+// the priorities are drawn up front, as the source is not meant to be shared between threads
+Treap::Link Treap::build_(const std::vector<long long> &values, size_t threads)
+{
+    std::vector<size_t> priority(values.size());
+    for (size_t &p : priority)
+        p = PrioritySource::next();
+    return build_(values.data(), priority.data(), values.size(), threads);
+}
 
-    struct SumPermutation : public Query //1, 6, 7
+// inserts batch[0..n) into t, whose first element is at position offset of the whole sequence
+Treap::Link Treap::insert_(Link t, const Insertion *batch, const size_t *priority, size_t n, size_t offset,
+                           size_t threads)
+{
+    if (n == 0) return t;
+    if (t == nullptr)
     {
-        size_t left, right;
-        void read(std::istream &in)
-        {
-            in >> left >> right;
-        }
-    };
+        std::vector<long long> values(n);
+        for (size_t i = 0; i < n; ++i)
+            values[i] = batch[i].second;
+        return build_(values.data(), priority, n, threads);
+    }
+    size_t mid = n / 2, work = n + t->size, key = std::min(batch[mid].first - offset, t->size);
+    Link left, right;
+    split_(t, left, right, key);
+    fork_join_(threads, work,
+               [&]() { left = insert_(left, batch, priority, mid, offset, threads / 2); },
+               [&]() { right = insert_(right, batch + mid + 1, priority + mid + 1, n - mid - 1, offset + key,
+                                       threads - threads / 2); });
+    merge_(left, left, new Node(batch[mid].second, priority[mid]));
+    merge_(t, left, right);
+    return t;
+}
 
-    struct PaintAdd : public SumPermutation // 4, 5
+// the number of distinct arrangements of a multiset given by its counts, capped at INF_COUNT
+size_t Treap::multinomial_(const std::vector<size_t> &count)
+{
+    size_t answer = 1, total = 0;
+    for (size_t c : count)
     {
-        long long x;
-        void read(std::istream &in)
-        {
-            in >> x;
-            SumPermutation::read(in);
-        }
-    };
+        if (c == 0) continue;
+        unsigned __int128 binomial = 1;
+        for (size_t i = 1; i <= std::min(c, total) && binomial < INF_COUNT; ++i)
+            binomial = binomial * (total + c - std::min(c, total) + i) / i;
+        total += c;
+        answer = (binomial >= INF_COUNT || answer * binomial >= INF_COUNT
+                  ? INF_COUNT
+                  : static_cast<size_t>(answer * binomial));
+        if (answer == INF_COUNT) break;
+    }
+    return answer;
+}
 
-    struct Remove : public Query // 3
+// Moves `values` `steps` arrangements forward (type 0) or backward (type 1) in lexicographic
+// order by ranking them among the arrangements of their multiset. If that leaves `values`,
+// returns false and changes nothing, unless they are the whole segment: then it wraps around.
+bool Treap::advance_(std::vector<long long> &values, size_t type, size_t &steps, bool whole)
+{
+    std::vector<long long> distinct(values);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    size_t n = values.size(), d = distinct.size();
+    std::vector<size_t> rank(n);
+    for (size_t i = 0; i < n; ++i)
     {
-        size_t pos;
-        void read(std::istream &in)
-        {
-            in >> pos;
-        }
-    };
+        rank[i] = std::lower_bound(distinct.begin(), distinct.end(), values[i]) - distinct.begin();
+        if (type) rank[i] = d - 1 - rank[i];
+    }
 
-    struct Insert : public Remove // 2
+    // after[i] is the number of arrangements of rank[i..] that follow the current one and
+    // total[i] the number of all of them; one more element multiplies total by length / count
+    std::vector<size_t> count(d, 0), fenwick(d + 1, 0), after(n + 1, 0), total(n + 1, 1);
+    for (size_t i = n; i-- > 0;)
     {
-        long long x;
-        void read(std::istream &in)
+        ++count[rank[i]];
+        size_t not_greater = 0;
+        for (size_t j = rank[i] + 1; j <= d; j += j & (0 - j))
+            ++fenwick[j];
+        for (size_t j = rank[i] + 1; j > 0; j -= j & (0 - j))
+            not_greater += fenwick[j];
+        size_t length = n - i, greater = length - not_greater;
+        unsigned __int128 grown = (unsigned __int128)(total[i + 1]) * length / count[rank[i]];
+        total[i] = (total[i + 1] == INF_COUNT || grown >= INF_COUNT ? INF_COUNT : static_cast<size_t>(grown));
+        if (greater == 0)
         {
-            in >> x;
-            Remove::read(in);
+            after[i] = after[i + 1];
+            continue;
         }
-    };
+        unsigned __int128 starting_greater = (unsigned __int128)(total[i]) * greater / length;
+        after[i] = (total[i] == INF_COUNT || after[i + 1] + starting_greater >= INF_COUNT
+                    ? INF_COUNT
+                    : static_cast<size_t>(after[i + 1] + starting_greater));
+    }
 
-    struct Data
+    if (after[0] < steps)
     {
-        std::vector<long long> elements;
-        std::vector<Query*> query;
-    };
-}
-
-std::vector<long long> read_elements(std::istream &in)
-{
-    size_t n;
-    in >> n;
-    std::vector<long long> answer(n);
-    for (size_t i = 0; i < n; ++i)
-        in >> answer[i];
-    return answer;
-}
+        if (!whole) return false;
+        steps -= after[0] + 1; // to the last arrangement and over to the first one
+        if (total[0] < INF_COUNT) steps %= total[0];
+        std::sort(rank.begin(), rank.end());
+        for (size_t i = 0; i < n; ++i)
+            values[i] = distinct[type ? d - 1 - rank[i] : rank[i]];
+        return steps == 0 || advance_(values, type, steps, whole);
+    }
 
-std::vector<query_utility::Query*> read_queries(std::istream &in)
-{
-    size_t q;
-    in >> q;
-    std::vector<query_utility::Query*> query(q);
-    for (size_t i = 0; i < q; ++i)
+    // the first position that changes, and the index among the arrangements of the rest
+    size_t first = n - 1;
+    while (after[first] < steps)
+        --first;
+    size_t index = steps - after[first + 1] - 1;
+    std::fill(count.begin(), count.end(), 0);
+    for (size_t i = first; i < n; ++i)
+        ++count[rank[i]];
+    // arrangements of what is left to place; the share starting with r is exact below the cap
+    size_t left = total[first];
+    for (size_t i = first; i < n; ++i)
     {
-        size_t type_id;
-        in >> type_id;
-        Treap::QueryType type = static_cast<Treap::QueryType>(type_id);
-        if (type == Treap::SUM ||
-            type == Treap::NEXT_PERMUTATION ||
-            type == Treap::PREV_PERMUTATION)
+        for (size_t r = (i == first ? rank[i] + 1 : 0); r < d; ++r)
         {
-            query[i] = new query_utility::SumPermutation;
-            dynamic_cast<query_utility::SumPermutation*>(query[i])->read(in);
+            if (count[r] == 0) continue;
+            size_t block = (left < INF_COUNT
+                            ? static_cast<size_t>((unsigned __int128)(left) * count[r] / (n - i))
+                            : 0);
+            --count[r];
+            if (left == INF_COUNT)
+                block = multinomial_(count);
+            if (index < block)
+            {
+                rank[i] = r;
+                left = block;
+                break;
+            }
+            index -= block;
+            ++count[r];
         }
-        if (type == Treap::PAINT || type == Treap::ADD)
+        if (index == 0)
         {
-            query[i] = new query_utility::PaintAdd;
-            dynamic_cast<query_utility::PaintAdd*>(query[i])->read(in);
+            // the first arrangement of the rest: ascending
+            for (size_t r = 0, j = i + 1; r < d; ++r)
+                for (; count[r] > 0; --count[r])
+                    rank[j++] = r;
+            break;
         }
-        if (type == Treap::REMOVE)
-        {
-            query[i] = new query_utility::Remove;
-            dynamic_cast<query_utility::Remove*>(query[i])->read(in);
-        }
-        if (type == Treap::INSERT)
-        {
-            query[i] = new query_utility::Insert;
-            dynamic_cast<query_utility::Insert*>(query[i])->read(in);
-        }
-        query[i]->type = type;
     }
-    return query;
-}
-
-query_utility::Data read_data(std::istream &in)
-{
-    query_utility::Data answer = { read_elements(in), read_queries(in) };
-    return answer;
+    for (size_t i = first; i < n; ++i)
+        values[i] = distinct[type ? d - 1 - rank[i] : rank[i]];
+    steps = 0;
+    return true;
 }
 
-std::vector<long long> process_data(Treap &t, const query_utility::Data &data)
+// After one ordinary step the part behind the pivot is sorted, so the following steps only
+// reorder a short tail: it is cut out, advanced arithmetically and put back in one go.
+void Treap::permute(Link &t, QueryType permutation_type, size_t steps)
 {
-    for (size_t i = 0; i < data.elements.size(); ++i)
-        t.insert(data.elements[i], i);
-
-    std::vector<long long> answer;
-    for (query_utility::Query* q : data.query)
+    if (steps == 0) return;
+    permute(t, permutation_type);
+    --steps;
+    for (size_t tail_size = 16; steps > 0; tail_size *= 2)
     {
-        if (q->type == Treap::SUM ||
-            q->type == Treap::NEXT_PERMUTATION ||
-            q->type == Treap::PREV_PERMUTATION)
-        {
-            query_utility::SumPermutation *ptr = dynamic_cast<query_utility::SumPermutation*>(q);
-            if (ptr->type == Treap::SUM)
-                answer.push_back(t.get_sum(ptr->left, ptr->right));
-            else
-                t.permute(ptr->left, ptr->right, ptr->type);
-        } else if (q->type == Treap::PAINT || q->type == Treap::ADD)
-        {
-            query_utility::PaintAdd *ptr = dynamic_cast<query_utility::PaintAdd*>(q);
-            if (ptr->type == Treap::PAINT)
-                t.paint(ptr->x, ptr->left, ptr->right);
-            else
-                t.add(ptr->x, ptr->left, ptr->right);
-        } else if (q->type == Treap::INSERT)
-        {
-            query_utility::Insert *ptr = dynamic_cast<query_utility::Insert*>(q);
-            t.insert(ptr->x, ptr->pos);
-        } else
+        tail_size = std::min(tail_size, subtree_size_(t));
+        Link head, tail;
+        split_(t, head, tail, subtree_size_(t) - tail_size);
+        std::vector<long long> values(subtree_size_(tail));
+        write_(tail, Tag(), values.data(), 1);
+        if (advance_(values, permutation_type == NEXT_PERMUTATION ? 0 : 1, steps, head == nullptr))
         {
-            t.remove(dynamic_cast<query_utility::Remove*>(q)->pos);
+            destruct(tail);
+            tail = build_(values);
         }
+        merge_(t, head, tail);
     }
-    return answer;
 }
 
-void print_query_answer(const std::vector<long long> &query_answer, std::ostream &out)
+void Treap::permute(size_t left, size_t right, QueryType permutation_type)
 {
-    for (auto i : query_answer)
-        out << i << "\n";
+    perform_operation<void>(left, right, [permutation_type](Link & t)
+    { permute(t, permutation_type); });
 }
 
-void print_answer(Treap &t, const std::vector<long long> &answer, std::ostream &out)
+void Treap::permute(size_t left, size_t right, QueryType permutation_type, size_t steps)
 {
-    print_query_answer(answer, out);
-    t.print(out);
+    perform_operation<void>(left, right, [permutation_type, steps](Link & t)
+    { permute(t, permutation_type, steps); });
 }
 
-void solution(std::istream &in, std::ostream &out)
+// Same operations as Treap, but every node keeps a block of up to BLOCK consecutive values.
+// Lazy tags of a node apply to its own block lazily too, so whole-block updates are O(1)
+// and the values are rewritten (in tight, vectorizable loops) only when a block is cut or scanned.
+class BlockTreap
 {
-    Treap t;
-    query_utility::Data data = read_data(in);
-    std::vector<long long> query_answer = process_data(t, data);
-    print_answer(t, query_answer, out);
-}
+private:
 
-int main()
-{
-    std::ios_base::sync_with_stdio(false);
-    std::istream &in = std::cin;
-    std::ostream &out = std::cout;
-    solution(in, out);
-    return 0;
+    static const size_t BLOCK = 128;
+    static const long long INF_VALUE = static_cast<long long>(1e14);
+    static const size_t INF_INDEX = static_cast<size_t>(1e9);
+
+    struct Block
+    {
+        long long values[BLOCK];
+        size_t count;
+        bool reversed, inversion[2];
+        long long paint, add, sum, bound[2], border[2];
+
+        Block();
+        void reverse();
+        void assign(const long long&);
+        void increase(const long long&);
+        void normalize();
+        void update();
+    };
+
+    struct Node
+    {
+        Block block;
+        long long bound[2], border[2], paint, add, sum;
+        size_t priority, size;
+        bool reversed, inversion[2];
+        Node *child[2];
+
+        Node();
+    };
+    typedef Node *Link;
+
+    Link root_;
+
+    static bool compare(const long long&, const long long&, size_t);
+    static long long min_max(const long long&, const long long&, size_t);
+    static size_t subtree_size_(Link);
+    static long long subtree_sum_(Link);
+    static void subtree_reverse_(Link&);
+    static void subtree_paint_(Link&, const long long&);
+    static void subtree_add_(Link&, const long long&);
+    static void update_(Link);
+    static void push_(Link);
+    static Link cut_(Link, size_t);
+    static void split_(Link, Link &, Link &, size_t);
+    static void merge_(Link &, Link, Link);
+    static size_t border_count_(Link, size_t);
+    static void join_(Link &, Link, Link);
+
+    class SegmentSplitter
+    {
+    private:
+        Link &root_, left_part, mid, right_part;
+    public:
+        SegmentSplitter(Link&, size_t, size_t);
+        ~SegmentSplitter();
+        Link &get();
+    };
+
+    template<typename Output>
+    static void print_(Link, Output&);
+    static void collect_(Link, std::vector<long long>&);
+    static size_t get_inversion_(Link, size_t, size_t);
+    static size_t get_nearest_(Link, const long long&, size_t, size_t);
+    static void permute(Link&, Treap::QueryType);
+    static void destruct(Link);
+
+    template<typename ReturnType, typename Operation>
+    ReturnType perform_operation(size_t, size_t, Operation operate);
+
+public:
+
+    BlockTreap();
+    BlockTreap(const BlockTreap&) = delete;
+    BlockTreap &operator=(const BlockTreap&) = delete;
+    ~BlockTreap();
+    void insert(const long long&, size_t);
+    void remove(size_t);
+    void paint(const long long&, size_t, size_t);
+    void add(const long long&, size_t, size_t);
+    long long get_sum(size_t, size_t);
+    void permute(size_t, size_t, Treap::QueryType);
+    size_t size() const;
+    std::vector<long long> values();
+    template<typename Output>
+    void print(Output&);
+};
+
+BlockTreap::Block::Block()
+        : count(0)
+        , reversed(false)
+        , inversion{false, false}
+        , paint(INF_VALUE)
+        , add(0)
+        , sum(0)
+        , bound{INF_VALUE, -INF_VALUE}
+        , border{0, 0}
+{}
+
+void BlockTreap::Block::reverse()
+{
+    reversed ^= 1;
+    std::swap(inversion[0], inversion[1]);
+    std::swap(border[0], border[1]);
+}
+
+void BlockTreap::Block::assign(const long long &x)
+{
+    paint = bound[0] = bound[1] = border[0] = border[1] = x;
+    add = inversion[0] = inversion[1] = 0;
+    sum = (long long)(count) * x;
+}
+
+void BlockTreap::Block::increase(const long long &x)
+{
+    add += x;
+    sum += (long long)(count) * x;
+    for (size_t type = 0; type < 2; ++type)
+    {
+        bound[type] += x;
+        border[type] += x;
+    }
+}
+
+// applies the pending tags to the stored values
+void BlockTreap::Block::normalize()
+{
+    if (paint != INF_VALUE)
+    {
+        std::fill(values, values + count, paint);
+    } else if (reversed)
+    {
+        std::reverse(values, values + count);
+    }
+    if (add != 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+            values[i] += add;
+    }
+    reversed = false;
+    paint = INF_VALUE;
+    add = 0;
+}
+
+// recounts the aggregates of a normalized block
+void BlockTreap::Block::update()
+{
+    sum = 0;
+    bound[0] = INF_VALUE;
+    bound[1] = -INF_VALUE;
+    inversion[0] = inversion[1] = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sum += values[i];
+        bound[0] = std::min(bound[0], values[i]);
+        bound[1] = std::max(bound[1], values[i]);
+        if (i > 0)
+        {
+            inversion[0] |= values[i - 1] < values[i];
+            inversion[1] |= values[i - 1] > values[i];
+        }
+    }
+    border[0] = values[0];
+    border[1] = values[count - 1];
+}
+
+BlockTreap::Node::Node()
+        : bound{INF_VALUE, -INF_VALUE}
+        , border{0, 0}
+        , paint(INF_VALUE)
+        , add(0)
+        , sum(0)
+        , priority(PrioritySource::next())
+        , size(0)
+        , reversed(false)
+        , inversion{false, false}
+        , child{nullptr, nullptr}
+{}
+
+bool BlockTreap::compare(const long long &a, const long long &b, size_t type)
+{
+    if (type) return a > b;
+    return a < b;
+}
+
+long long BlockTreap::min_max(const long long &a, const long long &b, size_t type)
+{
+    if (type) return std::max(a, b);
+    return std::min(a, b);
+}
+
+size_t BlockTreap::subtree_size_(Link t)
+{
+    return t != nullptr ? t->size : 0;
+}
+
+long long BlockTreap::subtree_sum_(Link t)
+{
+    return t != nullptr ? t->sum : 0;
+}
+
+void BlockTreap::subtree_reverse_(Link &t)
+{
+    if (t == nullptr) return;
+    t->reversed ^= 1;
+    t->block.reverse();
+    std::swap(t->inversion[0], t->inversion[1]);
+    std::swap(t->child[0], t->child[1]);
+    std::swap(t->border[0], t->border[1]);
+}
+
+void BlockTreap::subtree_paint_(Link &t, const long long &x)
+{
+    if (t == nullptr) return;
+    t->block.assign(x);
+    t->bound[0] = t->bound[1] = t->border[0] = t->border[1] = t->paint = x;
+    t->add = t->inversion[0] = t->inversion[1] = 0;
+    t->sum = (long long)(t->size) * x;
+}
+
+void BlockTreap::subtree_add_(Link &t, const long long &x)
+{
+    if (t == nullptr) return;
+    t->block.increase(x);
+    for (size_t type = 0; type < 2; ++type)
+    {
+        t->bound[type] += x;
+        t->border[type] += x;
+    }
+    t->add += x;
+    t->sum += (long long)(t->size) * x;
+}
+
+void BlockTreap::update_(Link t)
+{
+    if (t == nullptr) return;
+    Link left = t->child[0], right = t->child[1];
+    t->size = subtree_size_(left) + t->block.count + subtree_size_(right);
+    t->sum = subtree_sum_(left) + t->block.sum + subtree_sum_(right);
+    for (size_t type = 0; type < 2; ++type)
+    {
+        t->bound[type] = t->block.bound[type];
+        t->inversion[type] = t->block.inversion[type];
+        if (left != nullptr)
+        {
+            t->bound[type] = min_max(t->bound[type], left->bound[type], type);
+            t->inversion[type] |= left->inversion[type] ||
+                                  compare(left->border[1], t->block.border[0], type);
+        }
+        if (right != nullptr)
+        {
+            t->bound[type] = min_max(t->bound[type], right->bound[type], type);
+            t->inversion[type] |= right->inversion[type] ||
+                                  compare(t->block.border[1], right->border[0], type);
+        }
+    }
+    t->border[0] = (left != nullptr ? left->border[0] : t->block.border[0]);
+    t->border[1] = (right != nullptr ? right->border[1] : t->block.border[1]);
+}
+
+void BlockTreap::push_(Link t)
+{
+    if (t == nullptr) return;
+    if (t->reversed)
+    {
+        for (Link son : t->child)
+            subtree_reverse_(son);
+        t->reversed = false;
+    }
+    if (t->paint != INF_VALUE)
+    {
+        for (Link son : t->child)
+            subtree_paint_(son, t->paint);
+        t->paint = INF_VALUE;
+    }
+    if (t->add != 0)
+    {
+        for (Link son : t->child)
+            subtree_add_(son, t->add);
+        t->add = 0;
+    }
+}
+
+// moves the values of t's block from position `key` on, together with t's right subtree,
+// to a new node and returns it
+BlockTreap::Link BlockTreap::cut_(Link t, size_t key)
+{
+    Link tail = new Node();
+    tail->priority = t->priority;
+    t->block.normalize();
+    std::copy(t->block.values + key, t->block.values + t->block.count, tail->block.values);
+    tail->block.count = t->block.count - key;
+    t->block.count = key;
+    tail->child[1] = t->child[1];
+    t->child[1] = nullptr;
+    t->block.update();
+    tail->block.update();
+    update_(t);
+    update_(tail);
+    return tail;
+}
+
+void BlockTreap::split_(Link t, Link &left, Link &right, size_t key)
+{
+    push_(t);
+    if (t == nullptr)
+    {
+        left = right = nullptr;
+        return;
+    }
+    size_t left_size = subtree_size_(t->child[0]);
+    if (key <= left_size)
+    {
+        split_(t->child[0], left, t->child[0], key);
+        right = t;
+    } else if (key >= left_size + t->block.count)
+    {
+        split_(t->child[1], t->child[1], right, key - left_size - t->block.count);
+        left = t;
+    } else
+    {
+        right = cut_(t, key - left_size);
+        left = t;
+    }
+    update_(t);
+}
+
+void BlockTreap::merge_(Link &t, Link left, Link right)
+{
+    push_(left);
+    push_(right);
+    if (left == nullptr || right == nullptr)
+        t = (left != nullptr ? left : right);
+    else if (left->priority > right->priority)
+    {
+        merge_(left->child[1], left->child[1], right);
+        t = left;
+    } else
+    {
+        merge_(right->child[0], left, right->child[0]);
+        t = right;
+    }
+    update_(t);
+}
+
+// the number of values in the first (side = 0) or the last (side = 1) block of t
+size_t BlockTreap::border_count_(Link t, size_t side)
+{
+    push_(t);
+    while (t->child[side] != nullptr)
+    {
+        t = t->child[side];
+        push_(t);
+    }
+    return t->block.count;
+}
+
+// merge that coalesces the two blocks meeting at the seam if they fit into one
+void BlockTreap::join_(Link &t, Link left, Link right)
+{
+    if (left == nullptr || right == nullptr ||
+        border_count_(left, 1) + border_count_(right, 0) > BLOCK)
+    {
+        merge_(t, left, right);
+        return;
+    }
+    Link last, first;
+    split_(left, left, last, left->size - border_count_(left, 1));
+    split_(right, first, right, border_count_(right, 0));
+    last->block.normalize();
+    first->block.normalize();
+    std::copy(first->block.values, first->block.values + first->block.count,
+              last->block.values + last->block.count);
+    last->block.count += first->block.count;
+    last->block.update();
+    update_(last);
+    delete first;
+    merge_(t, left, last);
+    merge_(t, t, right);
+}
+
+BlockTreap::SegmentSplitter::SegmentSplitter(Link &t, size_t left, size_t right)
+        : root_(t)
+        , left_part(nullptr)
+        , mid(nullptr)
+        , right_part(nullptr)
+{
+    split_(root_, left_part, mid, left);
+    split_(mid, mid, right_part, right - left + 1);
+}
+
+BlockTreap::SegmentSplitter::~SegmentSplitter()
+{
+    join_(left_part, left_part, mid);
+    join_(root_, left_part, right_part);
+}
+
+BlockTreap::Link &BlockTreap::SegmentSplitter::get()
+{ return mid; }
+
+template<typename Output>
+void BlockTreap::print_(Link t, Output &out)
+{
+    if (t == nullptr) return;
+    push_(t);
+    print_(t->child[0], out);
+    t->block.normalize();
+    for (size_t i = 0; i < t->block.count; ++i)
+        out << t->block.values[i] << " ";
+    print_(t->child[1], out);
+}
+
+void BlockTreap::collect_(Link t, std::vector<long long> &values)
+{
+    if (t == nullptr) return;
+    push_(t);
+    collect_(t->child[0], values);
+    t->block.normalize();
+    values.insert(values.end(), t->block.values, t->block.values + t->block.count);
+    collect_(t->child[1], values);
+}
+
+size_t BlockTreap::get_inversion_(Link t, size_t type, size_t cur_key = 0)
+{
+    push_(t);
+    if (t == nullptr || t->inversion[type] == false)
+        return INF_INDEX;
+    Link left = t->child[0], right = t->child[1];
+    size_t block_key = cur_key + subtree_size_(left);
+    if (right != nullptr && right->inversion[type])
+        return get_inversion_(right, type, block_key + t->block.count);
+    if (right != nullptr && compare(t->block.border[1], right->border[0], type))
+        return block_key + t->block.count - 1;
+    if (t->block.inversion[type])
+    {
+        t->block.normalize();
+        size_t i = t->block.count - 1;
+        while (!compare(t->block.values[i - 1], t->block.values[i], type))
+            --i;
+        return block_key + i - 1;
+    }
+    if (left != nullptr && compare(left->border[1], t->block.border[0], type))
+        return block_key - 1;
+    return get_inversion_(left, type, cur_key);
+}
+
+size_t BlockTreap::get_nearest_(Link t, const long long &val, size_t type, size_t cur_key = 0)
+{
+    push_(t);
+    size_t block_key = cur_key + subtree_size_(t->child[0]);
+    if (t->child[1] != nullptr && compare(val, t->child[1]->bound[!type], type))
+        return get_nearest_(t->child[1], val, type, block_key + t->block.count);
+    if (compare(val, t->block.bound[!type], type))
+    {
+        t->block.normalize();
+        size_t i = t->block.count - 1;
+        while (!compare(val, t->block.values[i], type))
+            --i;
+        return block_key + i;
+    }
+    return get_nearest_(t->child[0], val, type, cur_key);
+}
+
+void BlockTreap::destruct(Link t)
+{
+    if (t == nullptr) return;
+    destruct(t->child[0]);
+    destruct(t->child[1]);
+    delete t;
+}
+
+template<typename ReturnType, typename Operation>
+ReturnType BlockTreap::perform_operation(size_t left, size_t right, Operation operate)
+{ return operate(SegmentSplitter(root_, left, right).get()); }
+
+BlockTreap::BlockTreap() : root_(nullptr) {}
+BlockTreap::~BlockTreap() { destruct(root_); }
+
+void BlockTreap::insert(const long long &x, size_t pos)
+{
+    perform_operation<void>(pos, pos - 1, [x](Link &t)
+    {
+        t = new Node();
+        t->block.values[0] = x;
+        t->block.count = 1;
+        t->block.update();
+        update_(t);
+    });
+}
+
+void BlockTreap::remove(size_t pos)
+{
+    perform_operation<void>(pos, pos, [](Link &t)
+    {
+        destruct(t);
+        t = nullptr;
+    });
+}
+
+long long BlockTreap::get_sum(size_t left, size_t right)
+{
+    return perform_operation<long long>(left, right, [](Link t)
+    { return subtree_sum_(t); });
+}
+
+void BlockTreap::paint(const long long &x, size_t left, size_t right)
+{
+    perform_operation<void>(left, right, [x](Link &t)
+    { subtree_paint_(t, x); });
+}
+
+void BlockTreap::add(const long long &x, size_t left, size_t right)
+{
+    perform_operation<void>(left, right, [x](Link &t)
+    { subtree_add_(t, x); });
+}
+
+size_t BlockTreap::size() const
+{ return subtree_size_(root_); }
+
+std::vector<long long> BlockTreap::values()
+{
+    std::vector<long long> answer;
+    answer.reserve(size());
+    collect_(root_, answer);
+    return answer;
+}
+
+template<typename Output>
+void BlockTreap::print(Output &out)
+{ print_(root_, out); out << "\n"; }
+
+void BlockTreap::permute(Link & t, Treap::QueryType permutation_type)
+{
+    size_t type = (permutation_type == Treap::NEXT_PERMUTATION ? 0 : 1);
+    size_t capture_key = get_inversion_(t, type);
+    if (capture_key == INF_INDEX)
+    {
+        subtree_reverse_(t);
+        return;
+    }
+    Link t_left, capture, suffix;
+    split_(t, t_left, capture, capture_key);
+    split_(capture, capture, suffix, 1);
+    capture->block.normalize();
+    size_t nearest_key = get_nearest_(suffix, capture->block.values[0], type);
+    Link suffix_left, nearest, suffix_right;
+    split_(suffix, suffix_left, nearest, nearest_key);
+    split_(nearest, nearest, suffix_right, 1);
+    join_(t, t_left, nearest);
+    join_(suffix_left, suffix_left, capture);
+    join_(suffix, suffix_left, suffix_right);
+    subtree_reverse_(suffix);
+    join_(t, t, suffix);
+}
+
+void BlockTreap::permute(size_t left, size_t right, Treap::QueryType permutation_type)
+{
+    perform_operation<void>(left, right, [permutation_type](Link & t)
+    { permute(t, permutation_type); });
+}
+
+// A single writer applies updates to writer() and publishes them; reader threads
+// query the last published version without locks. Versions share nodes, and the
+// writer frees a replaced version only once no reader may still be inside it.
+class ConcurrentTreap
+{
+private:
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<size_t> epoch;
+    };
+
+    static const size_t IDLE = std::numeric_limits<size_t>::max();
+
+    Treap writer_, published_;
+    std::atomic<Treap::Link> published_root_;
+    std::atomic<size_t> epoch_;
+    size_t readers_cnt_;
+    std::unique_ptr<ReaderSlot[]> readers_;
+    std::vector<std::pair<size_t, Treap>> retired_;
+
+    void reclaim_();
+
+public:
+    explicit ConcurrentTreap(size_t);
+    Treap &writer();
+    void publish();
+    long long get_sum(size_t, size_t, size_t);
+};
+
+ConcurrentTreap::ConcurrentTreap(size_t readers_cnt)
+        : published_root_(nullptr)
+        , epoch_(0)
+        , readers_cnt_(readers_cnt)
+        , readers_(new ReaderSlot[readers_cnt])
+{
+    for (size_t i = 0; i < readers_cnt_; ++i)
+        readers_[i].epoch = IDLE;
+}
+
+Treap &ConcurrentTreap::writer()
+{ return writer_; }
+
+void ConcurrentTreap::reclaim_()
+{
+    size_t oldest = IDLE;
+    for (size_t i = 0; i < readers_cnt_; ++i)
+        oldest = std::min(oldest, readers_[i].epoch.load());
+    size_t kept = 0;
+    for (size_t i = 0; i < retired_.size(); ++i)
+    {
+        if (retired_[i].first > oldest)
+            std::swap(retired_[kept++], retired_[i]);
+    }
+    retired_.resize(kept);
+}
+
+// writer thread only
+void ConcurrentTreap::publish()
+{
+    Treap version = writer_.snapshot();
+    published_root_.store(version.root_);
+    std::swap(published_, version);
+    retired_.emplace_back(epoch_.fetch_add(1) + 1, version);
+    reclaim_();
+}
+
+// reader thread reader_id only
+long long ConcurrentTreap::get_sum(size_t reader_id, size_t left, size_t right)
+{
+    ReaderSlot &slot = readers_[reader_id];
+    slot.epoch.store(epoch_.load());
+    Treap::Link root = published_root_.load();
+    long long answer = Treap::prefix_sum_(root, right + 1) - Treap::prefix_sum_(root, left);
+    slot.epoch.store(IDLE);
+    return answer;
+}
+
+namespace io_utility
+{
+    const size_t BUFFER_SIZE = 1 << 20;
+
+    // whitespace-separated decimal integers, parsed by hand from a large buffer
+    class FastInput
+    {
+    private:
+        FILE *file_;
+        std::unique_ptr<char[]> buffer_;
+        size_t size_, pos_;
+        bool good_;
+
+        int get_();
+
+    public:
+        explicit FastInput(FILE*);
+        explicit operator bool() const;
+
+        template<typename T>
+        FastInput &operator>>(T&);
+    };
+
+    FastInput::FastInput(FILE *file)
+            : file_(file)
+            , buffer_(new char[BUFFER_SIZE])
+            , size_(0)
+            , pos_(0)
+            , good_(true)
+    {}
+
+    FastInput::operator bool() const
+    { return good_; }
+
+    int FastInput::get_()
+    {
+        if (pos_ == size_)
+        {
+            size_ = fread(buffer_.get(), 1, BUFFER_SIZE, file_);
+            pos_ = 0;
+            if (size_ == 0) return EOF;
+        }
+        return static_cast<unsigned char>(buffer_[pos_++]);
+    }
+
+    template<typename T>
+    FastInput &FastInput::operator>>(T &x)
+    {
+        int c = get_();
+        while (c != EOF && c != '-' && (c < '0' || c > '9'))
+            c = get_();
+        if (c == EOF)
+        {
+            good_ = false;
+            return *this;
+        }
+        bool negative = (c == '-');
+        if (negative) c = get_();
+        unsigned long long value = 0;
+        for (; c >= '0' && c <= '9'; c = get_())
+            value = value * 10 + (c - '0');
+        x = static_cast<T>(negative ? 0 - value : value);
+        return *this;
+    }
+
+    // the same token stream as the text format, every token a 64-bit integer in host byte order
+    class BinaryInput
+    {
+    private:
+        FILE *file_;
+        std::unique_ptr<long long[]> buffer_;
+        size_t size_, pos_;
+        bool good_;
+
+    public:
+        explicit BinaryInput(FILE*);
+        explicit operator bool() const;
+
+        template<typename T>
+        BinaryInput &operator>>(T&);
+    };
+
+    BinaryInput::BinaryInput(FILE *file)
+            : file_(file)
+            , buffer_(new long long[BUFFER_SIZE / sizeof(long long)])
+            , size_(0)
+            , pos_(0)
+            , good_(true)
+    {}
+
+    BinaryInput::operator bool() const
+    { return good_; }
+
+    template<typename T>
+    BinaryInput &BinaryInput::operator>>(T &x)
+    {
+        if (pos_ == size_)
+        {
+            size_ = fread(buffer_.get(), sizeof(long long), BUFFER_SIZE / sizeof(long long), file_);
+            pos_ = 0;
+            if (size_ == 0)
+            {
+                x = 0;
+                good_ = false;
+                return *this;
+            }
+        }
+        x = static_cast<T>(buffer_[pos_++]);
+        return *this;
+    }
+
+    class FastOutput
+    {
+    private:
+        FILE *file_;
+        std::unique_ptr<char[]> buffer_;
+        size_t pos_;
+
+        void reserve_(size_t);
+
+    public:
+        explicit FastOutput(FILE*);
+        ~FastOutput();
+        void flush();
+        FastOutput &operator<<(long long);
+        FastOutput &operator<<(const char*);
+    };
+
+    FastOutput::FastOutput(FILE *file)
+            : file_(file)
+            , buffer_(new char[BUFFER_SIZE])
+            , pos_(0)
+    {}
+
+    FastOutput::~FastOutput()
+    { flush(); }
+
+    void FastOutput::flush()
+    {
+        fwrite(buffer_.get(), 1, pos_, file_);
+        fflush(file_);
+        pos_ = 0;
+    }
+
+    void FastOutput::reserve_(size_t length)
+    {
+        if (pos_ + length > BUFFER_SIZE)
+            flush();
+    }
+
+    FastOutput &FastOutput::operator<<(long long x)
+    {
+        reserve_(24);
+        unsigned long long value = (x < 0 ? 0 - (unsigned long long)(x) : x);
+        if (x < 0) buffer_[pos_++] = '-';
+        char digits[24];
+        size_t length = 0;
+        do
+        {
+            digits[length++] = char('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (length > 0)
+            buffer_[pos_++] = digits[--length];
+        return *this;
+    }
+
+    FastOutput &FastOutput::operator<<(const char *s)
+    {
+        size_t length = strlen(s);
+        reserve_(length);
+        if (length > BUFFER_SIZE)
+            fwrite(s, 1, length, file_);
+        else
+        {
+            memcpy(buffer_.get() + pos_, s, length);
+            pos_ += length;
+        }
+        return *this;
+    }
+
+    // rewrites a text input as the binary format
+    void convert_to_binary(FastInput &in, FILE *out)
+    {
+        long long token;
+        while (in >> token)
+            fwrite(&token, sizeof(token), 1, out);
+    }
+}
+
+namespace query_utility
+{
+    struct Segment
+    {
+        size_t left, right;
+    };
+
+    struct Query // a tagged union: `type` tells which member is active
+    {
+        Treap::QueryType type;
+        long long x; // 2, 4, 5, 10, 11; k for 12
+        union
+        {
+            Segment segment; // 1, 4-12
+            size_t pos;      // 2, 3
+        };
+    };
+
+    struct Data
+    {
+        std::vector<long long> elements;
+        std::vector<Query> query;
+    };
+
+    template<typename Input>
+    Query read_query(Input &in)
+    {
+        size_t type_id = 0;
+        in >> type_id;
+        Query query;
+        query.type = static_cast<Treap::QueryType>(type_id);
+        query.x = 0;
+        if (query.type == Treap::INSERT || query.type == Treap::PAINT || query.type == Treap::ADD ||
+            query.type == Treap::LOWER_BOUND || query.type == Treap::COUNT_LESS || query.type == Treap::KTH)
+            in >> query.x;
+        if (query.type == Treap::INSERT || query.type == Treap::REMOVE)
+            in >> query.pos;
+        else
+            in >> query.segment.left >> query.segment.right;
+        return query;
+    }
+
+    // a known type, and for KTH a k within the segment
+    bool well_formed(const Query &q)
+    {
+        if (q.type < Treap::SUM || q.type > Treap::KTH) return false;
+        return q.type != Treap::KTH || (q.segment.left <= q.segment.right && q.x >= 0 &&
+                                        static_cast<size_t>(q.x) <= q.segment.right - q.segment.left);
+    }
+
+    // sqrt decomposition over a copy of the values: counts elements below x in
+    // O(sqrt(n log n)) and finds the k-th smallest with a binary search over those counts;
+    // it has to be rebuilt after every update of the treap
+    class CountIndex
+    {
+    private:
+        std::vector<long long> values_, sorted_;
+        size_t block_;
+        long long min_, max_;
+
+    public:
+        CountIndex();
+        void build(std::vector<long long>);
+        size_t count_less(const long long&, size_t, size_t) const;
+        long long kth(size_t, size_t, size_t) const;
+    };
+
+    CountIndex::CountIndex() : block_(1), min_(0), max_(0) {}
+
+    void CountIndex::build(std::vector<long long> values)
+    {
+        values_ = std::move(values);
+        sorted_ = values_;
+        block_ = 1;
+        while (block_ * block_ < values_.size() * 16)
+            block_ *= 2;
+        for (size_t begin = 0; begin < sorted_.size(); begin += block_)
+            std::sort(sorted_.begin() + begin, sorted_.begin() + std::min(begin + block_, sorted_.size()));
+        min_ = max_ = (values_.empty() ? 0 : values_[0]);
+        for (size_t begin = 0; begin < sorted_.size(); begin += block_)
+        {
+            min_ = std::min(min_, sorted_[begin]);
+            max_ = std::max(max_, sorted_[std::min(begin + block_, sorted_.size()) - 1]);
+        }
+    }
+
+    size_t CountIndex::count_less(const long long &x, size_t left, size_t right) const
+    {
+        size_t answer = 0, i = left;
+        for (; i <= right && i % block_ != 0; ++i)
+            answer += (values_[i] < x);
+        for (; i + block_ - 1 <= right; i += block_)
+            answer += std::lower_bound(sorted_.begin() + i, sorted_.begin() + i + block_, x) - (sorted_.begin() + i);
+        for (; i <= right; ++i)
+            answer += (values_[i] < x);
+        return answer;
+    }
+
+    // the same search as Treap::get_kth, between the bounds of all the values: up to 64
+    // count_less calls of O(sqrt(n log n)) each
+    long long CountIndex::kth(size_t k, size_t left, size_t right) const
+    {
+        long long low = min_, high = max_;
+        while (low < high)
+        {
+            long long mid = static_cast<long long>(static_cast<unsigned long long>(low)
+                                                   + (static_cast<unsigned long long>(high) - low) / 2 + 1);
+            if (count_less(mid, left, right) <= k)
+                low = mid;
+            else
+                high = mid - 1;
+        }
+        return low;
+    }
+
+    class BatchExecutor
+    {
+    private:
+        Treap &treap_;
+        std::vector<long long> answer_;
+        CountIndex count_index_;
+        size_t count_queries_; // COUNT_LESS and KTH queries since the last update; the index is valid from the second one
+
+        static bool is_update(const Query &q)
+        { return q.type == Treap::PAINT || q.type == Treap::ADD; }
+
+        static bool same_segment(const Query &a, const Query &b)
+        { return a.segment.left == b.segment.left && a.segment.right == b.segment.right; }
+
+        static bool is_read(const Query &q)
+        { return q.type == Treap::SUM || q.type >= Treap::MIN; }
+
+        static bool is_permutation(const Query &q)
+        { return q.type == Treap::NEXT_PERMUTATION || q.type == Treap::PREV_PERMUTATION; }
+
+        size_t fold_updates_(const std::vector<Query>&, size_t);
+        size_t fold_permutations_(const std::vector<Query>&, size_t);
+        size_t answer_sums_(const std::vector<Query>&, size_t);
+        void execute_(const Query&);
+
+    public:
+        explicit BatchExecutor(Treap&);
+        std::vector<long long> run(const std::vector<Query>&);
+    };
+
+    BatchExecutor::BatchExecutor(Treap &t)
+            : treap_(t)
+            , count_queries_(0)
+    {}
+
+    // applies a run of PAINT/ADD queries on the same segment as a single one
+    size_t BatchExecutor::fold_updates_(const std::vector<Query> &query, size_t begin)
+    {
+        Query folded = query[begin];
+        size_t end = begin + 1;
+        for (; end < query.size() && is_update(query[end]) && same_segment(folded, query[end]); ++end)
+        {
+            if (query[end].type == Treap::PAINT)
+                folded.type = Treap::PAINT, folded.x = query[end].x;
+            else
+                folded.x += query[end].x;
+        }
+        execute_(folded);
+        return end;
+    }
+
+    // applies a run of identical permutation queries as a single multi-step one
+    size_t BatchExecutor::fold_permutations_(const std::vector<Query> &query, size_t begin)
+    {
+        size_t end = begin + 1;
+        while (end < query.size() && query[end].type == query[begin].type && same_segment(query[begin], query[end]))
+            ++end;
+        count_queries_ = 0;
+        treap_.permute(query[begin].segment.left, query[begin].segment.right, query[begin].type, end - begin);
+        return end;
+    }
+
+    // answers a run of SUM queries; a long run is served by one traversal of the treap
+    size_t BatchExecutor::answer_sums_(const std::vector<Query> &query, size_t begin)
+    {
+        size_t end = begin;
+        while (end < query.size() && query[end].type == Treap::SUM)
+            ++end;
+        size_t size = treap_.size(), depth = 1;
+        while ((size_t(1) << depth) < size)
+            ++depth;
+        if ((end - begin) * depth < size)
+        {
+            for (size_t i = begin; i < end; ++i)
+                execute_(query[i]);
+            return end;
+        }
+        std::vector<long long> prefix_sum = treap_.values();
+        prefix_sum.insert(prefix_sum.begin(), 0);
+        for (size_t i = 1; i < prefix_sum.size(); ++i)
+            prefix_sum[i] += prefix_sum[i - 1];
+        for (size_t i = begin; i < end; ++i)
+            answer_.push_back(prefix_sum[query[i].segment.right + 1] - prefix_sum[query[i].segment.left]);
+        return end;
+    }
+
+    void BatchExecutor::execute_(const Query &q)
+    {
+        if (!is_read(q))
+            count_queries_ = 0;
+        switch (q.type)
+        {
+            case Treap::SUM:
+                answer_.push_back(treap_.get_sum(q.segment.left, q.segment.right));
+                break;
+            case Treap::INSERT:
+                treap_.insert(q.x, q.pos);
+                break;
+            case Treap::REMOVE:
+                treap_.remove(q.pos);
+                break;
+            case Treap::PAINT:
+                treap_.paint(q.x, q.segment.left, q.segment.right);
+                break;
+            case Treap::ADD:
+                treap_.add(q.x, q.segment.left, q.segment.right);
+                break;
+            case Treap::MIN:
+                answer_.push_back(treap_.get_min(q.segment.left, q.segment.right));
+                break;
+            case Treap::MAX:
+                answer_.push_back(treap_.get_max(q.segment.left, q.segment.right));
+                break;
+            case Treap::LOWER_BOUND:
+            {
+                size_t pos = treap_.lower_bound(q.x, q.segment.left, q.segment.right);
+                answer_.push_back(pos <= q.segment.right ? (long long)(pos) : -1);
+                break;
+            }
+            case Treap::COUNT_LESS:
+                if (++count_queries_ == 2)
+                    count_index_.build(treap_.values());
+                answer_.push_back(count_queries_ >= 2
+                                  ? count_index_.count_less(q.x, q.segment.left, q.segment.right)
+                                  : treap_.count_less(q.x, q.segment.left, q.segment.right));
+                break;
+            case Treap::KTH:
+                if (++count_queries_ == 2)
+                    count_index_.build(treap_.values());
+                answer_.push_back(count_queries_ >= 2
+                                  ? count_index_.kth(q.x, q.segment.left, q.segment.right)
+                                  : treap_.get_kth(q.x, q.segment.left, q.segment.right));
+                break;
+            default:
+                treap_.permute(q.segment.left, q.segment.right, q.type);
+        }
+    }
+
+    std::vector<long long> BatchExecutor::run(const std::vector<Query> &query)
+    {
+        answer_.clear();
+        for (size_t i = 0; i < query.size();)
+        {
+            if (query[i].type == Treap::SUM)
+                i = answer_sums_(query, i);
+            else if (is_update(query[i]))
+                i = fold_updates_(query, i);
+            else if (is_permutation(query[i]))
+                i = fold_permutations_(query, i);
+            else
+                execute_(query[i++]);
+        }
+        return answer_;
+    }
+}
+
+template<typename Input>
+std::vector<long long> read_elements(Input &in)
+{
+    size_t n = 0;
+    in >> n;
+    std::vector<long long> answer(n);
+    for (size_t i = 0; i < n; ++i)
+        in >> answer[i];
+    return answer;
+}
+
+template<typename Input>
+std::vector<query_utility::Query> read_queries(Input &in)
+{
+    size_t q = 0;
+    in >> q;
+    std::vector<query_utility::Query> query(q);
+    for (size_t i = 0; i < q; ++i)
+        query[i] = query_utility::read_query(in);
+    return query;
+}
+
+template<typename Input>
+query_utility::Data read_data(Input &in)
+{
+    query_utility::Data answer = { read_elements(in), read_queries(in) };
+    return answer;
+}
+
+std::vector<long long> process_data(Treap &t, const query_utility::Data &data)
+{
+    t = Treap(data.elements);
+    return query_utility::BatchExecutor(t).run(data.query);
+}
+
+// BlockTreap answers the original query types (1-7) one by one
+std::vector<long long> process_data(BlockTreap &t, const query_utility::Data &data)
+{
+    for (size_t i = 0; i < data.elements.size(); ++i)
+        t.insert(data.elements[i], i);
+    std::vector<long long> answer;
+    for (const query_utility::Query &q : data.query)
+    {
+        switch (q.type)
+        {
+            case Treap::SUM:
+                answer.push_back(t.get_sum(q.segment.left, q.segment.right));
+                break;
+            case Treap::INSERT:
+                t.insert(q.x, q.pos);
+                break;
+            case Treap::REMOVE:
+                t.remove(q.pos);
+                break;
+            case Treap::PAINT:
+                t.paint(q.x, q.segment.left, q.segment.right);
+                break;
+            case Treap::ADD:
+                t.add(q.x, q.segment.left, q.segment.right);
+                break;
+            case Treap::NEXT_PERMUTATION:
+            case Treap::PREV_PERMUTATION:
+                t.permute(q.segment.left, q.segment.right, q.type);
+                break;
+            default: // 8-12 are refused by supports before anything runs
+                break;
+        }
+    }
+    return answer;
+}
+
+bool supports(const Treap&, const query_utility::Query&)
+{ return true; }
+
+bool supports(const BlockTreap&, const query_utility::Query &q)
+{ return q.type <= Treap::PREV_PERMUTATION; }
+
+template<typename Output>
+void print_query_answer(const std::vector<long long> &query_answer, Output &out)
+{
+    for (auto i : query_answer)
+        out << i << "\n";
+}
+
+template<typename TreapType, typename Output>
+void print_answer(TreapType &t, const std::vector<long long> &answer, Output &out)
+{
+    print_query_answer(answer, out);
+    t.print(out);
+}
+
+// returns nullptr, or what is wrong with the input; nothing is processed then
+template<typename TreapType, typename Input, typename Output>
+const char *solution(Input &in, Output &out)
+{
+    TreapType t;
+    query_utility::Data data = read_data(in);
+    if (!in) return "truncated input";
+    for (const query_utility::Query &q : data.query)
+    {
+        if (!query_utility::well_formed(q)) return "malformed query";
+        if (!supports(t, q)) return "query type not supported by this treap (--blocks takes 1-7)";
+    }
+    std::vector<long long> query_answer = process_data(t, data);
+    print_answer(t, query_answer, out);
+    return nullptr;
+}
+
+template<typename TreapType, typename Input, typename Output>
+int run(Input &in, Output &out)
+{
+    const char *error = solution<TreapType>(in, out);
+    if (error == nullptr) return 0;
+    fprintf(stderr, "%s\n", error);
+    return 1;
+}
+
+template<typename TreapType>
+int run(const std::string &mode)
+{
+    if (mode == "--to-binary")
+    {
+        io_utility::FastInput in(stdin);
+        io_utility::convert_to_binary(in, stdout);
+        return 0;
+    }
+    if (mode == "--fast")
+    {
+        io_utility::FastInput in(stdin);
+        io_utility::FastOutput out(stdout);
+        return run<TreapType>(in, out);
+    }
+    if (mode == "--binary")
+    {
+        io_utility::BinaryInput in(stdin);
+        io_utility::FastOutput out(stdout);
+        return run<TreapType>(in, out);
+    }
+    std::ios_base::sync_with_stdio(false);
+    std::istream &in = std::cin;
+    std::ostream &out = std::cout;
+    return run<TreapType>(in, out);
+}
+
+// no flag: iostream; --fast: buffered text; --binary: binary input, buffered text output;
+// --to-binary: convert a text input to the binary format;
+// --blocks (along with any of the above): use BlockTreap, queries 1-7 only;
+// --seed <n>: seed node priorities for a reproducible tree shape
+int main(int argc, char **argv)
+{
+    const char *usage = "usage: treap [--fast | --binary | --to-binary] [--blocks] [--seed <n>]\n";
+    std::string mode;
+    bool blocks = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "--blocks")
+            blocks = true;
+        else if (argument == "--seed" && i + 1 < argc)
+        {
+            std::string text = argv[++i];
+            unsigned long long seed = 0;
+            auto parsed = std::from_chars(text.data(), text.data() + text.size(), seed);
+            if (text.empty() || parsed.ec != std::errc() || parsed.ptr != text.data() + text.size())
+            {
+                fprintf(stderr, "%s", usage);
+                return 1;
+            }
+            PrioritySource::seed(seed);
+        }
+        else if (mode.empty() && (argument == "--fast" || argument == "--binary" || argument == "--to-binary"))
+            mode = argument;
+        else
+        {
+            fprintf(stderr, "%s", usage);
+            return 1;
+        }
+    }
+    return blocks ? run<BlockTreap>(mode) : run<Treap>(mode);
 }